@@ -40,6 +40,24 @@
  * @see https://www.kernel.org/doc/Documentation/vm/hugetlbpage.txt */
 #define DEFAULT_NR_HUGEPAGES	100
 
+/** Maximum number of events which are fetched by a reactor worker at once */
+#define REACTOR_MAX_EVENTS	64
+
+/** Number of callbacks for a single file descriptor before a reactor worker services the next one */
+#define REACTOR_MAX_DRAIN	16
+
+/** Default number of iterations a consumer of a QUEUE_SIGNALLED_ADAPTIVE queue spins before it blocks */
+#define QUEUE_SIGNALLED_SPIN	10000
+
+/** Interval in nanoseconds at which blocked consumers of a QUEUE_SIGNALLED_ADAPTIVE queue check for cancellation */
+#define QUEUE_SIGNALLED_TIMEOUT	100000000
+
+/** Maximum number of threads which can have a magazine in a pool cache at the same time */
+#define POOL_CACHE_SLOTS	64
+
+/** Maximum number of NUMA nodes for which memtype_numa() provides a memory type */
+#define NUMA_MAX_NODES		64
+
 /** Width of log output in characters */
 #define LOG_WIDTH		80
 #define LOG_HEIGHT		25
@@ -20,6 +20,8 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  *********************************************************************************/
 
+#pragma once
+
 #include <jansson.h>
 
 #if JANSSON_VERSION_HEX < 0x020A00
@@ -43,3 +45,20 @@ size_t json_dumpb(const json_t *json, char *buffer, size_t size, size_t flags);
   #define htobe32(x) OSSwapHostToBigInt32(x)
   #define htobe64(x) OSSwapHostToBigInt64(x)
 #endif /* __MACH__ */
+
+#ifdef __MACH__
+  #include <sys/socket.h>
+
+  #define MSG_WAITFORONE 0
+
+  struct mmsghdr {
+	struct msghdr msg_hdr;
+	unsigned int msg_len;
+  };
+
+  /** Emulate recvmmsg() by calling recvmsg() once. */
+  int recvmmsg(int sd, struct mmsghdr *msgs, unsigned int len, int flags, struct timespec *timeout);
+
+  /** Emulate sendmmsg() by calling sendmsg() for every message. */
+  int sendmmsg(int sd, struct mmsghdr *msgs, unsigned int len, int flags);
+#endif /* __MACH__ */
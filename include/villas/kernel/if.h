@@ -112,6 +112,14 @@ int if_get_egress(struct sockaddr *sa, struct rtnl_link **link);
  */
 int if_get_irqs(struct interface *i);
 
+/** Get the NUMA node to which the NIC of this interface is attached.
+ *
+ * @param i A pointer to the interface structure
+ * @retval >=0 The NUMA node of the NIC.
+ * @retval -1 The interface is not backed by a PCI device or the system has no NUMA support.
+ */
+int if_get_numa_node(struct interface *i);
+
 /** Change the SMP affinity of NIC interrupts.
  *
  * @param i A pointer to the interface structure
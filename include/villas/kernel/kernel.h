@@ -46,6 +46,15 @@ int kernel_get_nr_hugepages();
 /** Set number of reserved hugepages. */
 int kernel_set_nr_hugepages(int nr);
 
+/** Get number of reserved hugepages with a size of \p pagesz bytes. */
+int kernel_get_nr_hugepages_size(size_t pagesz);
+
+/** Get number of hugepages with a size of \p pagesz bytes which are not in use. */
+int kernel_get_free_hugepages_size(size_t pagesz);
+
+/** Set number of reserved hugepages with a size of \p pagesz bytes. */
+int kernel_set_nr_hugepages_size(size_t pagesz, int nr);
+
 /** Get kernel cmdline parameter
  *
  * See https://www.kernel.org/doc/Documentation/kernel-parameters.txt
@@ -84,6 +93,13 @@ int kernel_get_page_size();
 /** Get the size of a huge page in bytes. */
 int kernel_get_hugepage_size();
 
+/** Get the NUMA node of a CPU.
+ *
+ * @retval >=0 The NUMA node of CPU \p cpu.
+ * @retval -1 The system has no NUMA support or the CPU does not exist.
+ */
+int kernel_get_cpu_numa_node(int cpu);
+
 /** Set SMP affinity of IRQ */
 int kernel_irq_setaffinity(unsigned irq, uintmax_t new, uintmax_t *old);
 
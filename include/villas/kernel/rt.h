@@ -26,12 +26,40 @@
 
 #pragma once
 
+#include <jansson.h>
+
+/** Parameters of the SCHED_DEADLINE scheduling policy.
+ *
+ * All values are given in seconds.
+ */
+struct rt_deadline {
+	double runtime;		/**< Worst-case execution time per period. Zero disables SCHED_DEADLINE. */
+	double deadline;	/**< Relative deadline. Defaults to the period if zero. */
+	double period;		/**< Activation period. */
+};
+
 int rt_init(int priority, int affinity);
 
+/** Apply scheduling settings to the calling thread only.
+ *
+ * Settings with a zero value are not changed. The thread keeps the
+ * process-wide settings which have been applied by rt_init().
+ *
+ * @param priority A SCHED_FIFO priority.
+ * @param affinity A CPU mask.
+ * @param dl Optional SCHED_DEADLINE parameters. Take precedence over \p priority.
+ */
+int rt_init_thread(int priority, int affinity, struct rt_deadline *dl);
+
+/** Parse SCHED_DEADLINE parameters from a JSON object. */
+int rt_parse_deadline(struct rt_deadline *dl, json_t *cfg);
+
 int rt_set_affinity(int affinity);
 
 int rt_set_priority(int priority);
 
+int rt_set_deadline(struct rt_deadline *dl);
+
 int rt_lock_memory();
 
 /** Checks for realtime (PREEMPT_RT) patched kernel.
@@ -85,6 +85,52 @@ struct mapping_entry {
 	};
 };
 
+/** A single operation of a compiled mapping plan. */
+struct mapping_step {
+	int type;			/**< One of the MAPPING_TYPE_* constants of struct mapping_entry. */
+
+	int offset;			/**< Offset within sample::data of the remapped sample. */
+	int length;			/**< The number of values which are written or 0 for all values of the original sample (only MAPPING_TYPE_DATA). */
+
+	union {
+		int src;		/**< MAPPING_TYPE_DATA: Offset within sample::data of the original sample. */
+		enum header_type hdr;	/**< MAPPING_TYPE_HDR */
+		enum timestamp_type ts;	/**< MAPPING_TYPE_TS */
+
+		struct {
+			struct hist *hist;	/**< The histogram which has been resolved from the statistics of the node. */
+			enum stats_type type;
+		} stats;		/**< MAPPING_TYPE_STATS */
+	};
+};
+
+/** A list of mapping entries compiled into a flat array of steps.
+ *
+ * Adjacent data ranges are merged into a single step which is copied with memcpy().
+ * Statistic histograms are looked up once when the plan is compiled.
+ */
+struct mapping_plan {
+	enum state state;
+
+	int length;			/**< The minimum length of a remapped sample (ignoring steps of unknown length). */
+
+	size_t nsteps;
+	struct mapping_step *steps;
+};
+
+/** Compile the list \p m of struct mapping_entry into a plan.
+ *
+ * @param s The statistics which are used for MAPPING_TYPE_STATS entries. If NULL, the statistics of mapping_entry::node are used.
+ * @retval 0 The plan has been compiled.
+ * @retval <>0 A statistic mapping refers to a node without statistics or an entry is invalid.
+ */
+int mapping_plan_init(struct mapping_plan *p, struct list *m, struct stats *s);
+
+int mapping_plan_destroy(struct mapping_plan *p);
+
+/** Remap a sample according to a compiled plan. Equivalent to mapping_remap(). */
+int mapping_plan_remap(struct mapping_plan *p, struct sample *remapped, struct sample *original);
+
 int mapping_remap(struct list *m, struct sample *remapped, struct sample *original, struct stats *s);
 
 int mapping_update(struct mapping_entry *e, struct sample *remapped, struct sample *new, struct stats *s);
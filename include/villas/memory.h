@@ -23,10 +23,15 @@
 
 #include <stddef.h>
 #include <stdint.h>
+#include <sys/types.h>
 
 #pragma once
 
 #define HUGEPAGESIZE	(1 << 21)
+#define HUGEPAGESIZE_1G	(1UL << 30)
+
+/** Minimal alignment of allocations from the hugepage arena. Matches the cache line size. */
+#define MEMORY_ARENA_ALIGN	64
 
 struct memtype;
 
@@ -52,17 +57,36 @@ struct memtype {
 	void *_vd; /**<Virtual data for possible state */
 };
 
+/** Number of size classes of memtype_managed. Class i holds free blocks with a length in [2^i, 2^(i+1)). */
+#define MEMBLOCK_CLASSES	48
+
+/** Granularity of block lengths and payload alignment of memtype_managed. */
+#define MEMBLOCK_ALIGN		16
+
 enum memblock_flags {
 	MEMBLOCK_USED = 1,
 };
 
 /** Descriptor of a memory block. Associated block always starts at
- * &m + sizeof(struct memblock). */
+ * &m + sizeof(struct memblock).
+ *
+ * Each block also knows the length of its predecessor (boundary tag),
+ * so that free blocks can be merged with both neighbours in constant time. */
 struct memblock {
-	struct memblock* prev;
-	struct memblock* next;
-	size_t len; /**<Length of the block; doesn't include the descriptor itself */
-	int flags;
+	size_t prev; /**< Length of the previous block or 0 for the first block */
+	size_t len; /**< Length of the block; doesn't include the descriptor itself. Multiple of MEMBLOCK_ALIGN, ORed with enum memblock_flags. */
+};
+
+/** State of a region which is managed by memtype_managed_init().
+ *
+ * Free blocks are kept in a doubly linked list per size class.
+ * All links are offsets relative to the start of the region so that the
+ * region can be mapped at different addresses by multiple processes.
+ */
+struct memmanager {
+	size_t len; /**< Offset of the end of the last block from the start of the region */
+	uint64_t classes; /**< Bit i is set if the list of class i is not empty */
+	off_t free[MEMBLOCK_CLASSES]; /**< Offsets of the first free block per size class or 0 */
 };
 
 /** @todo Unused for now */
@@ -77,6 +101,23 @@ struct memzone {
 /** Initilialize memory subsystem */
 int memory_init(int hugepages);
 
+/** Reserve and prefault a single region of hugepages which serves all further allocations of memtype_hugepage.
+ *
+ * Allocations which do not fit into the arena anymore fail.
+ *
+ * @param len The sum of memory_footprint() of all planned allocations.
+ * @param pagesz The size of the hugepages: HUGEPAGESIZE or HUGEPAGESIZE_1G.
+ * @retval 0 The arena has been reserved.
+ * @retval <>0 The kernel could not provide enough hugepages.
+ */
+int memory_arena_init(size_t len, size_t pagesz);
+
+/** Release the arena. All memory which has been allocated from it must not be used anymore. */
+int memory_arena_destroy();
+
+/** Get the number of bytes which an allocation of \p len bytes occupies in the arena. */
+size_t memory_footprint(size_t len, size_t alignment);
+
 /** Allocate \p len bytes memory of type \p m.
  *
  * @retval NULL If allocation failed.
@@ -88,7 +129,22 @@ void * memory_alloc_aligned(struct memtype *m, size_t len, size_t alignment);
 
 int memory_free(struct memtype *m, void *ptr, size_t len);
 
+/** Initialize a memory type which manages the region [ptr, ptr + len).
+ *
+ * The struct memtype and struct memmanager are placed at the beginning of the region.
+ * Allocation and release take constant time, regardless of the number of blocks.
+ */
 struct memtype * memtype_managed_init(void *ptr, size_t len);
 
+/** Get a memory type for hugepages which are placed on a NUMA node.
+ *
+ * The kernel prefers the given node when it faults in the pages,
+ * but falls back to other nodes if the node has no free hugepages left.
+ *
+ * @param node The NUMA node or -1 for no placement.
+ * @return A memory type which behaves like memtype_hugepage. For \p node < 0 memtype_hugepage itself.
+ */
+struct memtype * memtype_numa(int node);
+
 extern struct memtype memtype_heap;
 extern struct memtype memtype_hugepage;
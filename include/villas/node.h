@@ -35,6 +35,7 @@
 #include "list.h"
 #include "queue.h"
 #include "common.h"
+#include "kernel/rt.h"
 
 /** The data structure for a node.
  *
@@ -48,7 +49,10 @@ struct node
 	char *_name_long;	/**< Singleton: A string used to print to screen. */
 
 	int vectorize;		/**< Number of messages to send / recv at once (scatter / gather) */
-	int affinity;		/**< CPU Affinity of this node */
+	int affinity;		/**< CPU affinity of the threads which are dedicated to this node. */
+	int priority;		/**< SCHED_FIFO priority of the threads which are dedicated to this node. */
+	struct rt_deadline deadline; /**< Optional SCHED_DEADLINE parameters for the threads which are dedicated to this node. */
+	int numa_node;		/**< NUMA node for the buffers of the threads which are dedicated to this node or -1. */
 	int samplelen;		/**< The maximum number of values this node can receive. */
 
 	int id;			/**< An id of this node which is only unique in the scope of it's super-node (VILLASnode instance). */
@@ -129,10 +133,40 @@ int node_reverse(struct node *n);
 
 int node_read(struct node *n, struct sample *smps[], unsigned cnt);
 
+/** Send samples to a node.
+ *
+ * Samples in \p smps which are shared with other owners (refcnt > 1) are
+ * replaced by private copies before the write hooks of the node run.
+ * The caller keeps the ownership of whatever \p smps points to afterwards.
+ */
 int node_write(struct node *n, struct sample *smps[], unsigned cnt);
 
 int node_fd(struct node *n);
 
+/** Check if samples can be read from a node without blocking.
+ *
+ * Falls back to poll() with a zero timeout for node-types which do not implement node_type::available.
+ *
+ * @retval >0 Samples are available.
+ * @retval 0 No samples are available.
+ * @retval <0 The node-type supports neither node_type::available nor node_type::fd.
+ */
+int node_available(struct node *n);
+
+/** Handle an error condition of the file descriptor of a node which is not readable.
+ *
+ * @see node_type::poll_error
+ * @retval 0 The condition has been handled.
+ * @retval <0 The node-type does not implement node_type::poll_error or the node can not be read anymore.
+ */
+int node_poll_error(struct node *n);
+
+/** Get the number of bytes which the node will allocate from the hugepage arena.
+ *
+ * @see node_type::footprint
+ */
+size_t node_footprint(struct node *n);
+
 /** Parse an array or single node and checks if they exist in the "nodes" section.
  *
  * Examples:
@@ -149,6 +149,36 @@ struct node_type {
 
 	/** Return a file descriptor which can be used by poll / select to detect the availability of new data. */
 	int (*fd)(struct node *n);
+
+	/** Return the number of samples which can be read without blocking.
+	 *
+	 * This callback is optional. It is used by busy-polling paths
+	 * to check for new data without issuing a syscall.
+	 *
+	 * @param n	A pointer to the node object.
+	 * @return	The number of samples which are available. Zero if there are none.
+	 */
+	int (*available)(struct node *n);
+
+	/** Handle an error condition which poll() reports for the file descriptor of node_type::fd.
+	 *
+	 * This callback is optional. It is invoked instead of node_type::read if the
+	 * descriptor is not readable. Hence it must not block.
+	 *
+	 * @param n	A pointer to the node object.
+	 * @retval 0	The condition has been handled.
+	 * @retval <0	The node can not be read anymore.
+	 */
+	int (*poll_error)(struct node *n);
+
+	/** Return the number of bytes which this node will allocate from memtype_hugepage when it is started.
+	 *
+	 * This callback is optional. It is used to size the hugepage arena.
+	 *
+	 * @param n	A pointer to the node object.
+	 * @return	The sum of memory_footprint() of all allocations.
+	 */
+	size_t (*footprint)(struct node *n);
 };
 
 /** Initialize all registered node type subsystems.
@@ -30,6 +30,7 @@
 #pragma once
 
 #include "list.h"
+#include "uring.h"
 
 /* Forward declarations */
 struct node;
@@ -46,6 +47,13 @@ struct influxdb {
 	struct list fields;
 
 	int sd;
+
+	int io_uring;		/**< Send asynchronously via io_uring. */
+
+#ifdef WITH_LIBURING
+	struct uring uring;
+	char *pending;		/**< The buffer of the last send which might still be in use by the kernel. */
+#endif /* WITH_LIBURING */
 };
 
 /** @see node_type::print */
@@ -41,6 +41,7 @@ struct sample;
  */
 struct loopback {
 	int queuelen;
+	int spin;		/**< If non-zero, readers spin for this number of iterations before they block (see QUEUE_SIGNALLED_ADAPTIVE) */
 
 	struct queue_signalled queue;
 	struct pool pool;
@@ -64,4 +65,10 @@ int loopback_read(struct node *n, struct sample *smps[], unsigned cnt);
 /** @see node_type::write */
 int loopback_write(struct node *n, struct sample *smps[], unsigned cnt);
 
+/** @see node_type::available */
+int loopback_available(struct node *n);
+
+/** @see node_type::footprint */
+size_t loopback_footprint(struct node *n);
+
 /** @} */
@@ -65,4 +65,7 @@ int shmem_read(struct node *n, struct sample *smps[], unsigned cnt);
 /** @see node_type::write */
 int shmem_write(struct node *n, struct sample *smps[], unsigned cnt);
 
+/** @see node_type::available */
+int shmem_available(struct node *n);
+
 /** @} */
@@ -31,6 +31,8 @@
 
 #pragma once
 
+#include <pthread.h>
+#include <stdatomic.h>
 #include <sys/socket.h>
 #include <sys/un.h>
 #include <netinet/in.h>
@@ -48,6 +50,10 @@
 #endif /* WITH_LIBNL_ROUTE_30 */
 
 #include "node.h"
+#include "pool.h"
+#include "queue_signalled.h"
+#include "compat.h"
+#include "uring.h"
 
 /* Forward declarations */
 struct io_format;
@@ -55,12 +61,31 @@ struct io_format;
 /** The maximum length of a packet which contains stuct msg. */
 #define SOCKET_MAX_PACKET_LEN 1500
 
+/** The size of the buffer for the ancillary data (control messages) of a single datagram. */
+#define SOCKET_MAX_CTRL_LEN 256
+
+/** The maximum length of a datagram which is segmented by UDP_SEGMENT or coalesced by UDP_GRO. */
+#define SOCKET_GSO_MAX_LEN 65000
+
+/** The maximum number of segments per datagram (UDP_MAX_SEGMENTS of the kernel). */
+#define SOCKET_GSO_MAX_SEGMENTS 64
+
+/** The number of MSG_ZEROCOPY send buffers in multiples of node::vectorize. */
+#define SOCKET_ZEROCOPY_DEPTH 4
+
 enum socket_layer {
 	SOCKET_LAYER_ETH,
 	SOCKET_LAYER_IP,
 	SOCKET_LAYER_UDP
 };
 
+/** Source of the timestamps which are set in sample::ts::received and sample::ts::sent. */
+enum socket_timestamping {
+	SOCKET_TIMESTAMPING_NONE,	/**< The timestamps are set by node_read() after the path woke up. */
+	SOCKET_TIMESTAMPING_SOFTWARE,	/**< SO_TIMESTAMPING: the kernel timestamps packets in its network stack. */
+	SOCKET_TIMESTAMPING_HARDWARE	/**< SO_TIMESTAMPING: the NIC timestamps received packets. Sent packets get software timestamps. */
+};
+
 union sockaddr_union {
 	struct sockaddr sa;
 	struct sockaddr_storage ss;
@@ -72,18 +97,128 @@ union sockaddr_union {
 #endif
 };
 
+/** Buffers for receiving or sending a batch of datagrams with a single recvmmsg() / sendmmsg() call. */
+struct socket_batch {
+	int len;			/**< The maximum number of datagrams per system call. */
+	size_t size;			/**< The size of the buffer of a single datagram. */
+
+	char *buf;			/**< Payload of all datagrams (socket_batch::len * socket_batch::size bytes). */
+	char *ctrl;			/**< Control messages of all datagrams (socket_batch::len * SOCKET_MAX_CTRL_LEN bytes). */
+	struct mmsghdr *msgs;
+	struct iovec *iov;
+	union sockaddr_union *addrs;	/**< Source addresses of received datagrams. */
+	unsigned *first;		/**< Index of the first sample of each sent datagram (socket_batch::len + 1 entries). */
+};
+
+#ifdef __linux__
+/** A thread which receives datagrams on its own SO_REUSEPORT socket. */
+struct socket_worker {
+	struct node *node;
+
+	int sd;				/**< The socket of this worker. The first worker uses socket::sd. */
+	pthread_t thread;
+	atomic_bool stop;		/**< Set by socket_workers_stop() before the socket is shut down. */
+
+	struct socket_batch rx;
+};
+
+/** A PACKET_MMAP ring (TPACKET_V3) which is shared with the kernel (only for SOCKET_LAYER_ETH).
+ *
+ * Received frames are parsed in place and released back to the kernel block by block.
+ * Frames for sending are formatted directly into the TX ring and flushed with a single sendto().
+ */
+struct socket_ring {
+	int enabled;
+
+	struct tpacket_req3 req;	/**< Geometry of the RX ring. The TX ring uses the same number of blocks and frames. */
+
+	char *map;			/**< The mmap()ed RX ring followed by the TX ring. */
+	size_t maplen;
+
+	unsigned rx_block;		/**< Index of the RX block which is currently processed. */
+	unsigned rx_pkts;		/**< The number of packets left in the current RX block. */
+	struct tpacket3_hdr *rx_pkt;	/**< The next packet of the current RX block or NULL. */
+
+	unsigned tx_frame;		/**< Index of the next TX frame. */
+	unsigned tx_nr;			/**< The number of frames in the TX ring. */
+};
+
+/** Launch times of sent datagrams (SO_TXTIME).
+ *
+ * The datagrams are held back by the ETF qdisc (or the NIC) until their launch time.
+ * The qdisc must be configured externally, e.g. with tc-etf(8).
+ */
+struct socket_txtime {
+	int enabled;
+	int deadline;			/**< SOF_TXTIME_DEADLINE_MODE: the launch time is a deadline instead of an exact time. */
+
+	clockid_t clock;		/**< The clock of the launch times. Must match the clock of the ETF qdisc. */
+	int64_t offset;			/**< Added to sample::ts::origin of the first sample of a datagram (in nanoseconds). */
+};
+
+/** Page-aligned buffers for MSG_ZEROCOPY sends (only for SOCKET_LAYER_UDP).
+ *
+ * The kernel pins the pages of a buffer until it reports the completion of the send on the error queue.
+ * Only then the buffer is returned to socket_zerocopy::pool.
+ */
+struct socket_zerocopy {
+	struct pool pool;		/**< Free buffers. */
+
+	char **pending;			/**< Buffers in flight indexed by the id of their send modulo socket_zerocopy::depth. */
+	unsigned depth;			/**< The number of buffers. */
+	uint32_t next;			/**< The id which the kernel assigns to the next successful send. */
+
+	pthread_mutex_t lock;		/**< Protects socket_zerocopy::pending. Completions are also processed by socket_poll_error(). */
+};
+#endif /* __linux__ */
+
 struct socket {
 	int sd;				/**< The socket descriptor */
 	int mark;			/**< Socket mark for netem, routing and filtering */
 	int verify_source;		/**< Verify the source address of incoming packets against socket::remote. */
 
 	enum socket_layer layer;	/**< The OSI / IP layer which should be used for this socket */
+	enum socket_timestamping timestamping;
+
+	uint32_t tx_key;		/**< The SOF_TIMESTAMPING_OPT_ID of the next datagram which is sent. */
 
 	union sockaddr_union local;	/**< Local address of the socket */
 	union sockaddr_union remote;	/**< Remote address of the socket */
 
 	struct io_format *format;
 
+	struct socket_batch rx;		/**< Used by socket_read(). Up to node::vectorize datagrams. */
+	struct socket_batch tx;		/**< Used by socket_write(). Up to node::vectorize datagrams. */
+
+#ifdef __linux__
+	struct socket_ring ring;	/**< Optional PACKET_MMAP ring which replaces socket::rx and socket::tx. */
+#endif /* __linux__ */
+
+	int io_uring;			/**< Use io_uring instead of recvmmsg() / sendmmsg(). */
+
+	int gso;			/**< Send one sample per segment with UDP_SEGMENT and split datagrams coalesced by UDP_GRO. */
+	size_t gso_size;		/**< The maximum payload of a segment: the path MTU minus the IP and UDP headers. */
+	int zerocopy;			/**< Send from page-aligned pool buffers with MSG_ZEROCOPY. */
+	int nworkers;			/**< The number of receive threads which share the local address. */
+
+#ifdef __linux__
+	struct socket_txtime txtime;
+	struct socket_zerocopy zc;
+
+	struct socket_worker *workers;
+	struct pool pool;		/**< Samples which have been received by the workers. */
+	struct queue_signalled queue;	/**< The merged stream of all workers which is read by socket_read(). */
+#endif /* __linux__ */
+
+#ifdef WITH_LIBURING
+	struct uring rx_uring;		/**< Multishot receives into socket::rx_bufs. */
+	struct uring tx_uring;		/**< Batched sendmsg() requests for the datagrams of socket::tx. */
+
+	struct io_uring_buf_ring *rx_bufs; /**< Buffers which are provided to the kernel for multishot receives. */
+	char *rx_mem;			/**< Memory of all buffers in socket::rx_bufs. */
+	struct msghdr rx_msg;		/**< Lengths of the address and control data of multishot receives. */
+#endif /* WITH_LIBURING */
+
 	/* Multicast options */
 	struct multicast {
 		int enabled;		/**< Is multicast enabled? */
@@ -123,6 +258,12 @@ int socket_parse(struct node *n, json_t *cfg);
 /** @see node_type::print */
 char * socket_print(struct node *n);
 
+/** @see node_type::footprint */
+size_t socket_footprint(struct node *n);
+
+/** @see node_type::poll_error */
+int socket_poll_error(struct node *n);
+
 /** Generate printable socket address depending on the address family
  *
  * A IPv4 address is formatted as dotted decimals followed by the port/protocol number
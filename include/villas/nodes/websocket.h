@@ -113,4 +113,10 @@ int websocket_read(struct node *n, struct sample *smps[], unsigned cnt);
 /** @see node_type::write */
 int websocket_write(struct node *n, struct sample *smps[], unsigned cnt);
 
+/** @see node_type::available */
+int websocket_available(struct node *n);
+
+/** @see node_type::footprint */
+size_t websocket_footprint(struct node *n);
+
 /** @} */
@@ -34,12 +34,16 @@
 
 #include "list.h"
 #include "queue.h"
+#include "queue_signalled.h"
+#include "atomic.h"
 #include "pool.h"
 #include "bitset.h"
 #include "common.h"
 #include "hook.h"
 #include "mapping.h"
 #include "task.h"
+#include "reactor.h"
+#include "kernel/rt.h"
 
 /* Forward declarations */
 struct stats;
@@ -48,17 +52,37 @@ struct super_node;
 
 struct path_source {
 	struct node *node;
+	struct path *path;
 
 	bool masked;
 
 	struct pool pool;
 	struct list mappings;			/**< List of mappings (struct mapping_entry). */
+	struct mapping_plan plan;		/**< The mappings compiled by path_init2(). */
+
+	struct queue_signalled queue;		/**< Samples passed from the reader to the processing stage (only used by pipelined paths). */
+
+	pthread_t tid;				/**< The thread id of the reader stage (only used by pipelined paths). */
+};
+
+/** What happens if the queue of a path_destination is full. */
+enum path_overflow {
+	PATH_OVERFLOW_DROP_NEWEST,		/**< Discard the samples which do not fit into the queue anymore. */
+	PATH_OVERFLOW_DROP_OLDEST,		/**< Evict the oldest samples from the queue to make room. */
+	PATH_OVERFLOW_BLOCK			/**< Wait up to path_destination::overflow_timeout for free space. */
 };
 
 struct path_destination {
 	struct node *node;
+	struct path *path;
+
+	struct queue_signalled queue;
+
+	enum path_overflow overflow;		/**< The policy if path_destination::queue is full. */
+	double overflow_timeout;		/**< Maximum time in seconds to wait for free space (only used by PATH_OVERFLOW_BLOCK). */
+	atomic_size_t overruns;			/**< Number of samples which have been dropped due to a full queue. */
 
-	struct queue queue;
+	pthread_t tid;				/**< The thread id of the writer stage (only used by pipelined paths). */
 };
 
 /** The register mode determines under which condition the path is triggered. */
@@ -67,11 +91,19 @@ enum path_mode {
 	PATH_MODE_ALL				/**< The path is triggered only after all sources have received at least 1 sample. */
 };
 
+/** What a busy-polling path does if none of its sources had new samples. */
+enum path_backoff {
+	PATH_BACKOFF_NONE,			/**< Spin without any delay. */
+	PATH_BACKOFF_PAUSE,			/**< Execute a spin-wait hint (e.g. the x86 PAUSE instruction). */
+	PATH_BACKOFF_YIELD			/**< Yield the CPU by calling sched_yield(). */
+};
+
 /** The datastructure for a path. */
 struct path {
 	enum state state;			/**< Path state. */
 
 	enum path_mode mode;		/**< Determines when this path is triggered. */
+	enum path_backoff backoff;	/**< Used by busy-polling paths when no new samples are available. */
 
 	struct {
 		int nfds;
@@ -90,8 +122,16 @@ struct path {
 
 	double rate;			/**< A timeout for */
 	int enabled;			/**< Is this path enabled. */
+	int pipeline;			/**< Run separate reader, processing and writer stages for this path. */
+	int polling;			/**< Busy-poll the sources instead of waiting in poll(). */
+	int affinity;			/**< CPU affinity of the path thread. Zero inherits the process-wide setting. */
+	int priority;			/**< SCHED_FIFO priority of the path thread. Zero inherits the process-wide setting. */
+	struct rt_deadline deadline;	/**< Optional SCHED_DEADLINE parameters of the path thread. */
+	int numa_node;			/**< NUMA node on which the pools and queues of the path are placed or -1. */
 	int reverse;			/**< This path as a matching reverse path. */
 	int queuelen;			/**< The queue length for each path_destination::queue */
+	int pool_cache;			/**< Number of free samples which each thread keeps in a thread-local cache of the path pools (0 disables the cache). The pools are enlarged by this number per thread of the path. */
+	int occupancy;			/**< Track the fill level and high-water marks of the pools and queues of this path. */
 	int samplelen;			/**< Will be calculated based on path::sources.mappings */
 
 	char *_name;			/**< Singleton: A string which is used to print this path to screen. */
@@ -99,7 +139,9 @@ struct path {
 	struct bitset mask;		/**< A mask of path_sources which are enabled for poll(). */
 	struct bitset received;		/**< A mask of path_sources for which we already received samples. */
 
-	pthread_t tid;			/**< The thread id for this path. */
+	pthread_t tid;			/**< The thread id for this path (or its processing stage if pipelined). */
+	struct reactor *reactor;	/**< A shared event loop which runs this path instead of its own thread (optional). */
+	int worker;			/**< The index of the reactor worker which has been assigned to this path. */
 	json_t *cfg;			/**< A JSON object containing the configuration of the path. */
 };
 
@@ -114,6 +156,10 @@ int path_check(struct path *p);
 /** Start a path.
  *
  * Start a new pthread for receiving/sending messages over this path.
+ * If path::reactor has been set, the path is assigned to one of the
+ * reactor workers instead.
+ * Pipelined paths start an additional reader thread per source and
+ * a writer thread per destination.
  *
  * @param p A pointer to the path structure.
  * @retval 0 Success. Everything went well.
@@ -121,6 +167,12 @@ int path_check(struct path *p);
  */
 int path_start(struct path *p);
 
+/** Get the number of bytes which path_init2() will allocate from the hugepage arena.
+ *
+ * @see memory_arena_init()
+ */
+size_t path_footprint(struct path *p);
+
 /** Stop a path.
  *
  * @param p A pointer to the path structure.
@@ -26,13 +26,17 @@
 #pragma once
 
 #include <stddef.h>
+#include <stdint.h>
 #include <sys/types.h>
 
 #include "queue.h"
 #include "common.h"
 #include "memory.h"
 
-/** A thread-safe memory pool */
+/** A thread-safe memory pool
+ *
+ * This struct is part of struct shmem_shared (see SHMEM_VERSION).
+ */
 struct pool {
 	off_t  buffer_off; /**< Offset from the struct address to the underlying memory area */
 	struct memtype *mem;
@@ -45,6 +49,29 @@ struct pool {
 	size_t alignment;	/**< Alignment of a block in bytes */
 
 	struct queue queue; /**< The queue which is used to keep track of free blocks */
+
+	size_t cache_size;	/**< Number of blocks per thread-local magazine or 0 if the cache is disabled */
+	size_t cache_stride;	/**< Size of a single struct pool_cache including its blocks */
+	off_t  cache_off;	/**< Offset from the struct address to the array of magazines */
+
+	int occupancy;		/**< Track the number of blocks in use (see pool_occupancy_enable()) */
+	atomic_size_t used;	/**< Number of blocks which have been handed out and not returned yet */
+	atomic_size_t highwater;/**< Maximum of pool::used */
+	atomic_size_t failures;	/**< Number of requested blocks which could not be served */
+};
+
+/** A magazine of free blocks which is owned by a single thread.
+ *
+ * Blocks are taken and returned in LIFO order so that recently used blocks are still cache-hot.
+ * The magazine is refilled from / flushed to the shared queue in batches of half its capacity.
+ */
+struct pool_cache {
+	size_t count;		/**< Number of blocks currently held by this magazine */
+
+	uint64_t hits;		/**< Number of operations which have been served without touching the shared queue */
+	uint64_t misses;	/**< Number of operations which had to refill or flush the magazine */
+
+	void *blocks[];
 };
 
 #define INLINE static inline __attribute__((unused))
@@ -60,9 +87,67 @@ struct pool {
  */
 int pool_init(struct pool *p, size_t cnt, size_t blocksz, struct memtype *mem);
 
+/** Initialize a pool whose blocks start at multiples of \p alignment.
+ *
+ * Blocks are always aligned to at least the size of a cache line.
+ *
+ * @see pool_init()
+ */
+int pool_init_aligned(struct pool *p, size_t cnt, size_t blocksz, size_t alignment, struct memtype *mem);
+
 /** Destroy and release memory used by pool. */
 int pool_destroy(struct pool *p);
 
+/** Get the number of bytes which pool_init() and pool_cache_init() allocate from the hugepage arena.
+ *
+ * @param cache The \p size argument of pool_cache_init() or 0.
+ */
+size_t pool_footprint(size_t cnt, size_t blocksz, size_t cache);
+
+/** Get the number of bytes which pool_init_aligned() and pool_cache_init() allocate from the hugepage arena. */
+size_t pool_footprint_aligned(size_t cnt, size_t blocksz, size_t alignment, size_t cache);
+
+/** Put a thread-local magazine cache in front of the shared queue of the pool.
+ *
+ * Each of up to POOL_CACHE_SLOTS threads keeps a stack of up to \p size free blocks.
+ * Blocks which are held by a magazine are not available to other threads.
+ * Hence the pool should be sized accordingly.
+ *
+ * The cache must not be used for pools which are shared between processes.
+ *
+ * @param size The number of blocks per thread.
+ * @retval 0 The cache has been enabled.
+ * @retval <>0 Failed to allocate memory for the magazines.
+ */
+int pool_cache_init(struct pool *p, size_t size);
+
+/** Sum up the hit and miss counters of all magazines of the pool. */
+void pool_cache_stats(struct pool *p, uint64_t *hits, uint64_t *misses);
+
+/** Start counting the blocks which are in use.
+ *
+ * Must be called before the first block is taken from the pool.
+ */
+void pool_occupancy_enable(struct pool *p);
+
+/** Take a snapshot of the number of blocks in use, its high-water mark and the number of failed allocations.
+ *
+ * All counters are zero unless pool_occupancy_enable() has been called.
+ */
+void pool_occupancy(struct pool *p, struct queue_occupancy *o);
+
+/** Account for \p got of \p cnt requested blocks. Used by pool_get_many(). */
+void pool_occupancy_get(struct pool *p, size_t got, size_t cnt);
+
+/** Account for \p cnt returned blocks. Used by pool_put_many(). */
+void pool_occupancy_put(struct pool *p, size_t cnt);
+
+/** Take up to \p cnt blocks from the magazine of the calling thread. Use pool_get_many() instead. */
+ssize_t pool_cache_get_many(struct pool *p, void *blocks[], size_t cnt);
+
+/** Return \p cnt blocks to the magazine of the calling thread. Use pool_put_many() instead. */
+ssize_t pool_cache_put_many(struct pool *p, void *blocks[], size_t cnt);
+
 /** Pop up to \p cnt values from the stack an place them in the array \p blocks.
  *
  * @return The number of blocks actually retrieved from the pool.
@@ -71,24 +156,45 @@ int pool_destroy(struct pool *p);
  */
 INLINE ssize_t pool_get_many(struct pool *p, void *blocks[], size_t cnt)
 {
-	return queue_pull_many(&p->queue, blocks, cnt);
+	ssize_t got;
+
+	if (p->cache_size)
+		got = pool_cache_get_many(p, blocks, cnt);
+	else
+		got = queue_pull_many(&p->queue, blocks, cnt);
+
+	/* A failed pull counts as a failure for all requested blocks */
+	if (p->occupancy)
+		pool_occupancy_get(p, got > 0 ? got : 0, cnt);
+
+	return got;
 }
 
 /** Push \p cnt values which are giving by the array values to the stack. */
 INLINE ssize_t pool_put_many(struct pool *p, void *blocks[], size_t cnt)
 {
-	return queue_push_many(&p->queue, blocks, cnt);
+	ssize_t put;
+
+	if (p->cache_size)
+		put = pool_cache_put_many(p, blocks, cnt);
+	else
+		put = queue_push_many(&p->queue, blocks, cnt);
+
+	if (p->occupancy && put > 0)
+		pool_occupancy_put(p, put);
+
+	return put;
 }
 
 /** Get a free memory block from pool. */
 INLINE void * pool_get(struct pool *p)
 {
 	void *ptr;
-	return queue_pull(&p->queue, &ptr) == 1 ? ptr : NULL;
+	return pool_get_many(p, &ptr, 1) == 1 ? ptr : NULL;
 }
 
 /** Release a memory block back to the pool. */
 INLINE int pool_put(struct pool *p, void *buf)
 {
-	return queue_push(&p->queue, buf);
+	return pool_put_many(p, &buf, 1);
 }
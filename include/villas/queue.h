@@ -52,12 +52,34 @@ struct queue_cell {
 	off_t data_off; /**< Pointer relative to the queue struct */
 };
 
-/** A lock-free multiple-producer, multiple-consumer (MPMC) queue. */
+enum queue_flags {
+	QUEUE_MPMC	= 0,		/**< Multiple producers and consumers (default) */
+	QUEUE_SPSC	= (1 << 0),	/**< Exactly one producer and one consumer thread. Avoids all CAS operations. */
+	QUEUE_OCCUPANCY	= (1 << 1)	/**< Track the high-water mark and failed pushes. See queue_occupancy(). */
+};
+
+/** A snapshot of the fill level of a queue or pool. */
+struct queue_occupancy {
+	size_t capacity;	/**< Total number of cells (queue) or blocks (pool) */
+	size_t fill;		/**< Number of pointers in the queue or blocks taken from the pool at the time of the snapshot */
+	size_t highwater;	/**< The largest fill level which has been observed so far */
+	size_t failures;	/**< Number of pointers which could not be pushed (queue) or blocks which could not be allocated (pool) */
+};
+
+/** A lock-free multiple-producer, multiple-consumer (MPMC) queue.
+ *
+ * If initialized with QUEUE_SPSC, the same layout is used as a single-producer, single-consumer ring.
+ * In this mode the sequence numbers of the cells are unused.
+ *
+ * Queues reside in shared memory regions. Increment SHMEM_VERSION when changing this layout.
+ */
 struct queue {
 	cacheline_pad_t _pad0;	/**< Shared area: all threads read */
 
 	atomic_state state;
 
+	int flags;		/**< See enum queue_flags */
+
 	struct memtype *mem;
 	size_t buffer_mask;
 	off_t buffer_off; /**< Relative pointer to struct queue_cell[] */
@@ -65,20 +87,31 @@ struct queue {
 	cacheline_pad_t	_pad1;	/**< Producer area: only producers read & write */
 
 	atomic_size_t	tail;	/**< Queue tail pointer */
+	size_t		head_cache; /**< The last head pointer seen by the producer (only used by SPSC queues) */
+
+	atomic_size_t	highwater; /**< Maximum fill level after a push (only used with QUEUE_OCCUPANCY) */
+	atomic_size_t	failures;  /**< Number of pointers rejected because the queue was full (only used with QUEUE_OCCUPANCY) */
 
 	cacheline_pad_t	_pad2;	/**< Consumer area: only consumers read & write */
 
 	atomic_size_t	head;	/**< Queue head pointer */
+	size_t		tail_cache; /**< The last tail pointer seen by the consumer (only used by SPSC queues) */
 
 	cacheline_pad_t	_pad3;	/**< @todo Why needed? */
 };
 
-/** Initialize MPMC queue */
-int queue_init(struct queue *q, size_t size, struct memtype *mem);
+/** Initialize MPMC queue
+ *
+ * @param flags A bitmask of enum queue_flags.
+ */
+int queue_init(struct queue *q, size_t size, struct memtype *mem, int flags);
 
 /** Desroy MPMC queue and release memory */
 int queue_destroy(struct queue *q);
 
+/** Get the number of bytes which queue_init() allocates from the hugepage arena for a queue of \p size cells. */
+size_t queue_footprint(size_t size);
+
 /** Return estimation of current queue usage.
  *
  * Note: This is only an estimation and not accurate as long other
@@ -86,11 +119,19 @@ int queue_destroy(struct queue *q);
  */
 size_t queue_available(struct queue *q);
 
+/** Take a snapshot of the fill level of the queue.
+ *
+ * The high-water mark and failure counter are only maintained for queues which have been initialized with QUEUE_OCCUPANCY.
+ */
+void queue_occupancy(struct queue *q, struct queue_occupancy *o);
+
 int queue_push(struct queue *q, void *ptr);
 
 int queue_pull(struct queue *q, void **ptr);
 
 /** Enqueue up to \p cnt pointers of the \p ptr array into the queue.
+ *
+ * All consecutive free cells are reserved with a single compare-and-swap of the tail.
  *
  * @return The number of pointers actually enqueued.
  *         This number can be smaller then \p cnt in case the queue is filled.
@@ -98,6 +139,8 @@ int queue_pull(struct queue *q, void **ptr);
 int queue_push_many(struct queue *q, void *ptr[], size_t cnt);
 
 /** Dequeue up to \p cnt pointers from the queue and place them into the \p ptr array.
+ *
+ * All consecutive filled cells are reserved with a single compare-and-swap of the head.
  *
  * @return The number of pointers actually dequeued.
  *         This number can be smaller than \p cnt in case the queue contained less than
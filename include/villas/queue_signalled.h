@@ -34,14 +34,20 @@ enum queue_signalled_flags {
 	QUEUE_SIGNALLED_POLLING		= (2 << 0),
 #ifdef __linux__
 	QUEUE_SIGNALLED_EVENTFD		= (3 << 0),
+	QUEUE_SIGNALLED_ADAPTIVE	= (4 << 0), /**< Consumers spin for a while before they block on a futex. Producers only signal blocked consumers. */
 #endif
 	QUEUE_SIGNALLED_MASK		= 0xf,
 	
 	/* Other flags */
-	QUEUE_SIGNALLED_PROCESS_SHARED	= (1 << 4)
+	QUEUE_SIGNALLED_PROCESS_SHARED	= (1 << 4),
+	QUEUE_SIGNALLED_SPSC		= (1 << 5), /**< There is only one producer and one consumer thread (see QUEUE_SPSC) */
+	QUEUE_SIGNALLED_OCCUPANCY	= (1 << 6)  /**< Track the fill level of the underlying queue (see QUEUE_OCCUPANCY) */
 };
 
-/** Wrapper around queue that uses POSIX CV's for signalling writes. */
+/** Wrapper around queue that uses POSIX CV's for signalling writes.
+ *
+ * This struct is part of struct shmem_shared (see SHMEM_VERSION).
+ */
 struct queue_signalled {
 	struct queue queue;		/**< Actual underlying queue. */
 	
@@ -54,6 +60,13 @@ struct queue_signalled {
 		} pthread;
 #ifdef __linux__
 		int eventfd;
+
+		struct {
+			atomic_uint seq;	/**< Futex word which is incremented by producers to wake up blocked consumers. */
+			atomic_int waiters;	/**< Number of consumers which are blocked or about to block. */
+			int spin;		/**< Number of iterations a consumer spins before it blocks. Can be changed after initialization. */
+			int shared;		/**< Use process-shared futex operations. */
+		} adaptive;
 #endif
 	};
 };
@@ -72,7 +85,20 @@ int queue_signalled_push_many(struct queue_signalled *qs, void *ptr[], size_t cn
 
 int queue_signalled_pull_many(struct queue_signalled *qs, void *ptr[], size_t cnt);
 
+/** Dequeue up to \p cnt pointers without waiting for new data.
+ *
+ * Pending notifications are acknowledged before the queue is drained.
+ * This function must only be called after poll() reported the file
+ * descriptor returned by queue_signalled_fd() as readable.
+ */
+int queue_signalled_pull_many_ready(struct queue_signalled *qs, void *ptr[], size_t cnt);
+
 int queue_signalled_close(struct queue_signalled *qs);
 
-/** Returns a file descriptor which can be used with poll / select to wait for new data */
+/** Returns a file descriptor which can be used with poll / select to wait for new data
+ *
+ * Queues in the modes QUEUE_SIGNALLED_PTHREAD, QUEUE_SIGNALLED_POLLING and QUEUE_SIGNALLED_ADAPTIVE have none.
+ *
+ * @retval -1 The queue has no file descriptor.
+ */
 int queue_signalled_fd(struct queue_signalled *qs);
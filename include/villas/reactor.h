@@ -0,0 +1,107 @@
+/** Shared event loop which multiplexes many paths onto a small pool of worker threads.
+ *
+ * @file
+ * @author Steffen Vogel <stvogel@eonerc.rwth-aachen.de>
+ * @copyright 2017, Institute for Automation of Complex Power Systems, EONERC
+ * @license GNU General Public License (version 3)
+ *
+ * VILLASnode
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *********************************************************************************/
+
+/** @addtogroup reactor Reactor
+ * @{
+ */
+
+#pragma once
+
+#include <pthread.h>
+
+#include "list.h"
+#include "common.h"
+
+/** Callback which is invoked by a worker whenever a watched file descriptor becomes readable.
+ *
+ * @param ctx The context pointer which has been passed to reactor_add().
+ * @param idx The index which has been passed to reactor_add().
+ */
+typedef void (*reactor_cb_t)(void *ctx, int idx);
+
+/** A file descriptor which is watched by one of the workers. */
+struct reactor_watch {
+	int fd;			/**< The file descriptor which is registered with epoll. */
+	int idx;		/**< Passed unchanged to the callback. */
+	void *ctx;		/**< Passed unchanged to the callback. */
+	reactor_cb_t cb;
+	reactor_cb_t err;	/**< Invoked for EPOLLERR / EPOLLHUP without EPOLLIN. Optional. */
+};
+
+struct reactor_worker {
+	struct reactor *reactor;
+
+	int epfd;		/**< The epoll_create(2) file descriptor of this worker. */
+	int cpu;		/**< The CPU this worker is pinned to or -1. */
+	int load;		/**< The number of contexts which are assigned to this worker. */
+
+	pthread_t tid;		/**< The thread id of this worker. */
+	struct list watches;	/**< List of struct reactor_watch. */
+};
+
+struct reactor {
+	enum state state;
+
+	int affinity;		/**< Workers are pinned round-robin to the CPUs in this mask. */
+
+	int nworkers;
+	struct reactor_worker *workers;
+};
+
+/** Initialize a reactor with \p nworkers worker threads.
+ *
+ * @param affinity A CPU mask. If non-zero, worker i will be pinned to the i-th CPU of the mask (modulo its size).
+ */
+int reactor_init(struct reactor *r, int nworkers, int affinity);
+
+int reactor_destroy(struct reactor *r);
+
+int reactor_start(struct reactor *r);
+
+int reactor_stop(struct reactor *r);
+
+/** Select the worker with the fewest assigned contexts.
+ *
+ * All file descriptors of a single context (e.g. a path) should be added to the same worker.
+ * That way callbacks of the same context are never invoked concurrently.
+ *
+ * @return The index of the worker which should be passed to reactor_add().
+ */
+int reactor_assign(struct reactor *r);
+
+/** Watch file descriptor \p fd for readability.
+ *
+ * The descriptor is registered edge-triggered. After each callback the worker checks whether
+ * the descriptor is still readable and invokes the callback again until it is drained.
+ *
+ * Error conditions which are reported without the descriptor being readable are passed to \p err instead.
+ * As \p cb might block in this case, it is not invoked.
+ *
+ * @param err An optional callback for EPOLLERR / EPOLLHUP or NULL.
+ */
+int reactor_add(struct reactor *r, int worker, int fd, reactor_cb_t cb, reactor_cb_t err, void *ctx, int idx);
+
+/** Stop watching all file descriptors which have been added with context \p ctx. */
+int reactor_remove(struct reactor *r, void *ctx);
+
+/** @} */
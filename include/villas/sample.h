@@ -38,12 +38,18 @@ extern "C" {
 /* Forward declarations */
 struct pool;
 
+/** The number of values whose number representation is stored in sample::format. */
+#define SAMPLE_FORMAT_INLINE	64
+
 /** The length of a sample datastructure with \p values values in bytes. */
-#define SAMPLE_LEN(len)	(sizeof(struct sample) + SAMPLE_DATA_LEN(len))
+#define SAMPLE_LEN(len)	(sizeof(struct sample) + SAMPLE_DATA_LEN(len) + SAMPLE_FORMAT_LEN(len))
 
 /** The length of a sample data portion of a sample datastructure with \p values values in bytes. */
 #define SAMPLE_DATA_LEN(len)	((len) * sizeof(double))
 
+/** The length of the bitfield which stores the number representation of the values beyond SAMPLE_FORMAT_INLINE in bytes. */
+#define SAMPLE_FORMAT_LEN(len)	((len) > SAMPLE_FORMAT_INLINE ? ((len) - SAMPLE_FORMAT_INLINE + 63) / 64 * sizeof(uint64_t) : 0)
+
 /** The offset to the beginning of the data section. */
 #define SAMPLE_DATA_OFFSET(smp)	((char *) (smp) + offsetof(struct sample, data))
 
@@ -72,19 +78,30 @@ enum sample_flags {
 //	SAMPLE_DO_SKIP		= (1 << 20)  /**< This sample was skipped by a previous hook. */
 };
 
+/** A sample of simulation data.
+ *
+ * The header is split into two cache lines:
+ * The first one holds all fields which are accessed while samples are processed.
+ * The second one holds fields which are only used for bookkeeping.
+ * The values start at a cache line boundary so that they can be loaded with aligned SIMD instructions.
+ *
+ * The number representation of values beyond SAMPLE_FORMAT_INLINE is stored in a bitfield
+ * directly after sample::data[sample::capacity]. Use sample_get_data_format() and
+ * sample_set_data_format() to access it.
+ *
+ * Samples are exchanged via shared memory. Increment SHMEM_VERSION when changing this layout.
+ */
 struct sample {
+	/* Hot: first cache line */
 	int sequence;		/**< The sequence number of this sample. */
 	int length;		/**< The number of values in sample::values which are valid. */
-	int capacity;		/**< The number of values in sample::values for which memory is reserved. */
+	int capacity;		/**< The number of values in sample::values for which memory is reserved. Set by sample_init() and must never be changed afterwards. */
 	int flags;		/**< Flags are used to store binary properties of a sample. */
 
-	int id;			/**< The id field is usually the same as sample::source::id */
-	struct node *source;	/**< The node from which this sample originates. */
-
 	atomic_int refcnt;	/**< Reference counter. */
-	off_t pool_off;		/**< This sample belongs to this memory pool (relative pointer). See sample_pool(). */
+	int id;			/**< The id field is usually the same as sample::source::id */
 
-	/** A long bitfield indicating the number representation of the first 64 values in sample::data[].
+	/** A long bitfield indicating the number representation of the first SAMPLE_FORMAT_INLINE values in sample::data[].
 	 *
 	 * @see sample_data_format
 	 */
@@ -97,11 +114,15 @@ struct sample {
 		struct timespec sent;		/**< The point in time when this data was send for the last time. */
 	} ts;
 
+	/* Cold: second cache line (together with sample::ts::sent) */
+	off_t pool_off;		/**< This sample belongs to this memory pool (relative pointer). See sample_pool(). */
+	struct node *source;	/**< The node from which this sample originates. */
+
 	/** The values. */
 	union {
 		double  f;	/**< Floating point values. */
 		int64_t i;	/**< Integer values. */
-	} data[];		/**< Data is in host endianess! */
+	} data[] __attribute__((aligned(64)));	/**< Data is in host endianess! */
 };
 
 /** Get the address of the pool to which the sample belongs. */
@@ -0,0 +1,113 @@
+/** A structure-of-arrays representation of a batch of samples.
+ *
+ * @file
+ * @author Steffen Vogel <stvogel@eonerc.rwth-aachen.de>
+ * @copyright 2017, Institute for Automation of Complex Power Systems, EONERC
+ * @license GNU General Public License (version 3)
+ *
+ * VILLASnode
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *********************************************************************************/
+
+#pragma once
+
+#include <stdint.h>
+#include <time.h>
+
+#include "common.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Forward declarations */
+struct sample;
+struct memtype;
+
+/** Alignment of the columns of a sample batch in bytes. */
+#define SAMPLE_BATCH_ALIGN	64
+
+/** A single value of a column. Same representation as sample::data[]. */
+union sample_batch_value {
+	double  f;	/**< Floating point values. */
+	int64_t i;	/**< Integer values. */
+};
+
+/** A batch of samples stored as contiguous columns.
+ *
+ * Row j of the batch corresponds to the j-th sample and column i to sample::data[i].
+ * Each column is a separate array of sample_batch::capacity values which starts at a
+ * SAMPLE_BATCH_ALIGN byte boundary. That way hooks and IO formats can process a single
+ * signal of all samples in one tight loop which the compiler is able to vectorize.
+ *
+ * All rows of a batch share the same number representation per column (sample_batch::format).
+ */
+struct sample_batch {
+	enum state state;
+
+	int length;		/**< The number of rows which are valid. */
+	int capacity;		/**< The number of rows for which memory is reserved. */
+	int values;		/**< The number of columns. */
+	size_t stride;		/**< The distance between two columns in number of values. */
+
+
+	int *sequence;			/**< Sequence numbers of all rows. */
+	int *lengths;			/**< The number of valid values per row. */
+	int *flags;			/**< The sample::flags of all rows. */
+	struct timespec *origin;	/**< Origin timestamps of all rows. */
+	struct timespec *received;	/**< Receive timestamps of all rows. */
+	uint64_t *format;		/**< A bitfield with the number representation of all columns (see sample_data_format). */
+
+	union sample_batch_value *data;	/**< All columns. Use sample_batch_column() to access them. */
+
+	struct memtype *mem;
+	size_t len;		/**< The number of bytes which have been allocated for all arrays. */
+};
+
+/** Get a pointer to the first value of column \p idx. */
+#define sample_batch_column(b, idx) (&(b)->data[(idx) * (b)->stride])
+
+/** Allocate a batch for up to \p capacity samples with \p values values each.
+ *
+ * @param mem The type of memory which is used for the arrays of the batch.
+ * @retval 0 The batch has been successfully initialized.
+ * @retval <>0 Failed to allocate memory.
+ */
+int sample_batch_init(struct sample_batch *b, int capacity, int values, struct memtype *mem);
+
+/** Release the memory of a batch. */
+int sample_batch_destroy(struct sample_batch *b);
+
+/** Transpose up to sample_batch::capacity samples of \p smps into the batch.
+ *
+ * Values beyond sample_batch::values are ignored. Missing values of shorter samples are set to zero.
+ * The number representation of each column is taken from the first sample.
+ *
+ * @return The number of samples which have been converted.
+ */
+int sample_batch_from_samples(struct sample_batch *b, struct sample *smps[], int cnt);
+
+/** Transpose the rows of the batch back into the samples \p smps.
+ *
+ * The samples must have been allocated before (e.g. with sample_alloc_many()).
+ * Values which exceed sample::capacity are truncated.
+ *
+ * @return The number of samples which have been written.
+ */
+int sample_batch_to_samples(struct sample_batch *b, struct sample *smps[], int cnt);
+
+#ifdef __cplusplus
+}
+#endif
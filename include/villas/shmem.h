@@ -38,6 +38,14 @@ extern "C" {
 #include "queue_signalled.h"
 #include "sample.h"
 
+/** The version of the memory layout of struct shmem_shared.
+ *
+ * This includes all structures which reside in the shared region: struct queue,
+ * struct queue_signalled, struct pool and struct sample. Must be incremented whenever
+ * one of them changes. Both processes compare it to detect incompatible peers.
+ */
+#define SHMEM_VERSION		3
+
 #define DEFAULT_SHMEM_QUEUELEN	512
 #define DEFAULT_SHMEM_SAMPLELEN	64
 
@@ -47,10 +55,12 @@ struct shmem_conf {
 	int polling;			/**< Whether to use polling instead of POSIX CVs */
 	int queuelen;			/**< Size of the queues (in elements) */
 	int samplelen;			/**< Maximum number of data entries in a single sample */
+	int spin;			/**< If non-zero, readers spin for this number of iterations before they block on a futex (see QUEUE_SIGNALLED_ADAPTIVE) */
 };
 
 /** The structure that actually resides in the shared memory. */
 struct shmem_shared {
+	int version;			/**< The SHMEM_VERSION of the process which created this region. Must be the first member. */
 	int polling;			/**< Whether to use a pthread_cond_t to signal if new samples are written to incoming queue. */
 	struct queue_signalled queue;	/**< Queue for samples passed in both directions. */
 	struct pool pool;		/**< Pool for the samples in the queues. */
@@ -80,6 +90,7 @@ struct shmem_int {
  * @param[in] conf Configuration parameters for the output queue.
  * @retval 0 The objects were opened and initialized successfully.
  * @retval <0 An error occured; errno is set accordingly.
+ *             errno is EPROTO if the other process uses a different SHMEM_VERSION.
  */
 int shmem_int_open(const char* wname, const char* rname, struct shmem_int* shm, struct shmem_conf* conf);
 
@@ -25,13 +25,18 @@
 #define _STATS_H_
 
 #include <stdint.h>
+#include <stdatomic.h>
 #include <jansson.h>
 
 #include "hist.h"
+#include "list.h"
 
 /* Forward declarations */
 struct sample;
 struct node;
+struct pool;
+struct queue;
+struct queue_occupancy;
 
 enum stats_format {
 	STATS_FORMAT_HUMAN,
@@ -59,6 +64,10 @@ struct stats {
 	struct hist histograms[STATS_COUNT];
 
 	struct stats_delta *delta;
+
+	struct list pools;	/**< List of struct pool from which the node receives samples. */
+	struct list queues;	/**< List of struct queue through which samples are passed to the node. */
+	struct list overruns;	/**< List of atomic_size_t counters of samples which have been dropped before reaching the node. */
 };
 
 int stats_lookup_format(const char *str);
@@ -75,6 +84,26 @@ int stats_commit(struct stats *s);
 
 json_t * stats_json(struct stats *s);
 
+json_t * stats_occupancy_json(struct queue_occupancy *o);
+
+/** Include the occupancy of a pool into the output of stats_json(). */
+void stats_add_pool(struct stats *s, struct pool *p);
+
+/** Include the occupancy of a queue into the output of stats_json(). */
+void stats_add_queue(struct stats *s, struct queue *q);
+
+/** Include a counter of dropped samples into the output of stats_json() and stats_print_periodic().
+ *
+ * The counter is owned and updated by another thread (e.g. path_destination::overruns).
+ */
+void stats_add_overruns(struct stats *s, atomic_size_t *cnt);
+
+/** Sum of all counters which have been added by stats_add_overruns(). */
+size_t stats_overruns(struct stats *s);
+
+/** Remove a pool, queue or counter which has been added by stats_add_pool(), stats_add_queue() or stats_add_overruns(). */
+void stats_remove(struct stats *s, void *ptr);
+
 void stats_reset(struct stats *s);
 
 void stats_print_header();
@@ -27,6 +27,7 @@
 #include "api.h"
 #include "web.h"
 #include "log.h"
+#include "reactor.h"
 #include "common.h"
 
 /** Global configuration */
@@ -34,6 +35,9 @@ struct super_node {
 	int priority;		/**< Process priority (lower is better) */
 	int affinity;		/**< Process affinity of the server and all created threads */
 	int hugepages;		/**< Number of hugepages to reserve. */
+	int arena;		/**< Reserve all hugepages which are required by the nodes and paths at startup. */
+	size_t hugepage_size;	/**< The size of the hugepages of the arena: HUGEPAGESIZE or HUGEPAGESIZE_1G. */
+	int workers;		/**< Number of reactor workers which run the paths. Set to 0 to start one thread per path. */
 	double stats;		/**< Interval for path statistics. Set to 0 to disable them. */
 
 	struct list nodes;
@@ -43,6 +47,7 @@ struct super_node {
 	struct log log;
 	struct api api;
 	struct web web;
+	struct reactor reactor;
 
 	char *name;		/**< A name of this super node. Usually the hostname. */
 
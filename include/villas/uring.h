@@ -0,0 +1,80 @@
+/** Thin wrapper around liburing for asynchronous node I/O.
+ *
+ * @file
+ * @author Steffen Vogel <stvogel@eonerc.rwth-aachen.de>
+ * @copyright 2017, Institute for Automation of Complex Power Systems, EONERC
+ * @license GNU General Public License (version 3)
+ *
+ * VILLASnode
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *********************************************************************************/
+
+/** @addtogroup uring io_uring
+ * @{
+ */
+
+#pragma once
+
+#ifdef WITH_LIBURING
+
+#include <liburing.h>
+
+#include "common.h"
+
+/** The maximum number of completions which are reaped at once. */
+#define URING_MAX_BATCH 64
+
+/** An io_uring instance for requests which are submitted and later completed in batches (e.g. sends).
+ *
+ * A ring is not thread-safe. Each thread (e.g. the reading and writing side of a node) requires its own ring.
+ */
+struct uring {
+	enum state state;
+
+	struct io_uring ring;
+
+	unsigned inflight;	/**< The number of requests which have been queued but whose completions have not been reaped yet. */
+};
+
+/** Create a ring with a submission queue of \p depth entries. */
+int uring_init(struct uring *u, unsigned depth);
+
+/** Wait for all in-flight requests and destroy the ring. Does nothing if the ring has not been initialized. */
+int uring_destroy(struct uring *u);
+
+/** Get a free submission queue entry.
+ *
+ * If the submission queue is full, all queued entries are submitted first.
+ *
+ * @return A pointer to the entry or NULL.
+ */
+struct io_uring_sqe * uring_get_sqe(struct uring *u);
+
+/** Submit all queued entries with a single system call.
+ *
+ * @return The number of submitted entries or -1 on error (see errno).
+ */
+int uring_submit(struct uring *u);
+
+/** Wait until all in-flight requests have been completed and reap their completions in batches.
+ *
+ * @retval 0 All requests succeeded.
+ * @retval -1 At least one request failed. errno is set to the error of the first failed request.
+ */
+int uring_wait(struct uring *u);
+
+#endif /* WITH_LIBURING */
+
+/** @} */
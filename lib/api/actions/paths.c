@@ -24,8 +24,10 @@
 
 #include "plugin.h"
 #include "path.h"
+#include "node.h"
 #include "utils.h"
 #include "super_node.h"
+#include "stats.h"
 
 #include "api.h"
 
@@ -36,14 +38,57 @@ static int api_paths(struct api_action *r, json_t *args, json_t **resp, struct a
 	for (size_t i = 0; i < list_length(&s->api->super_node->paths); i++) {
 		struct path *p = (struct path *) list_at(&s->api->super_node->paths, i);
 
-		json_t *json_path = json_pack("{ s: i }",
-			"state",	p->state
-		);
+		json_t *json_destinations = json_array();
+
+		for (size_t j = 0; j < list_length(&p->destinations); j++) {
+			struct path_destination *pd = (struct path_destination *) list_at(&p->destinations, j);
+
+			json_t *json_destination = json_pack("{ s: s, s: I }",
+				"node",		pd->node->name,
+				"overruns",	(json_int_t) atomic_load(&pd->overruns)
+			);
+
+			if (p->occupancy) {
+				struct queue_occupancy o;
+
+				queue_occupancy(&pd->queue.queue, &o);
+				json_object_set_new(json_destination, "queue", stats_occupancy_json(&o));
+			}
+
+			json_array_append_new(json_destinations, json_destination);
+		}
+
+		json_t *json_path = json_object();
 
 		/* Add all additional fields of node here.
-		 * This can be used for metadata */
+		 * This can be used for metadata. The computed fields below take precedence. */
 		json_object_update(json_path, p->cfg);
 
+		json_object_set_new(json_path, "state", json_integer(p->state));
+		json_object_set_new(json_path, "numa_node", json_integer(p->numa_node));
+		json_object_set_new(json_path, "destinations", json_destinations);
+
+		if (p->occupancy) {
+			struct queue_occupancy o;
+			json_t *json_sources = json_array();
+
+			for (size_t j = 0; j < list_length(&p->sources); j++) {
+				struct path_source *ps = (struct path_source *) list_at(&p->sources, j);
+
+				pool_occupancy(&ps->pool, &o);
+
+				json_array_append_new(json_sources, json_pack("{ s: s, s: o }",
+					"node",		ps->node->name,
+					"pool",		stats_occupancy_json(&o)
+				));
+			}
+
+			pool_occupancy(&p->pool, &o);
+
+			json_object_set_new(json_path, "pool", stats_occupancy_json(&o));
+			json_object_set_new(json_path, "sources", json_sources);
+		}
+
 		json_array_append_new(json_paths, json_path);
 	}
 
@@ -44,3 +44,36 @@ size_t json_dumpb(const json_t *json, char *buffer, size_t size, size_t flags)
 	return len;
 }
 #endif
+
+#ifdef __MACH__
+int recvmmsg(int sd, struct mmsghdr *msgs, unsigned int len, int flags, struct timespec *timeout)
+{
+	ssize_t bytes;
+
+	if (len == 0)
+		return 0;
+
+	bytes = recvmsg(sd, &msgs[0].msg_hdr, flags);
+	if (bytes < 0)
+		return -1;
+
+	msgs[0].msg_len = bytes;
+
+	return 1;
+}
+
+int sendmmsg(int sd, struct mmsghdr *msgs, unsigned int len, int flags)
+{
+	ssize_t bytes;
+
+	for (unsigned int i = 0; i < len; i++) {
+		bytes = sendmsg(sd, &msgs[i].msg_hdr, flags);
+		if (bytes < 0)
+			return i > 0 ? i : -1;
+
+		msgs[i].msg_len = bytes;
+	}
+
+	return len;
+}
+#endif /* __MACH__ */
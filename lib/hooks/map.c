@@ -34,6 +34,7 @@
 
 struct map {
 	struct list mapping;
+	struct mapping_plan plan;
 
 	struct stats *stats;
 };
@@ -54,6 +55,20 @@ static int map_destroy(struct hook *h)
 	return list_destroy(&m->mapping, NULL, true);
 }
 
+static int map_start(struct hook *h)
+{
+	struct map *m = (struct map *) h->_vd;
+
+	return mapping_plan_init(&m->plan, &m->mapping, m->stats);
+}
+
+static int map_stop(struct hook *h)
+{
+	struct map *m = (struct map *) h->_vd;
+
+	return mapping_plan_destroy(&m->plan);
+}
+
 static int map_parse(struct hook *h, json_t *cfg)
 {
 	int ret;
@@ -92,11 +107,12 @@ static int map_process(struct hook *h, struct sample *smps[], unsigned *cnt)
 	if (ret != *cnt)
 		return ret;
 
+	/* sample_alloc_many() has reset the number representation of all values,
+	 * including those beyond SAMPLE_FORMAT_INLINE */
 	for (int i = 0; i < *cnt; i++) {
-		tmp[i]->format   = 0;
 		tmp[i]->length   = 0;
 
-		mapping_remap(&m->mapping, tmp[i], smps[i], m->stats);
+		mapping_plan_remap(&m->plan, tmp[i], smps[i]);
 
 		SWAP(smps[i], tmp[i]);
 	}
@@ -115,6 +131,8 @@ static struct plugin p = {
 		.priority = 99,
 		.init	= map_init,
 		.destroy= map_destroy,
+		.start	= map_start,
+		.stop	= map_stop,
 		.parse	= map_parse,
 		.process= map_process,
 		.size	= sizeof(struct map)
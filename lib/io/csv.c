@@ -40,7 +40,7 @@ size_t csv_sprint_single(char *buf, size_t len, struct sample *s, int flags)
 		off += snprintf(buf + off, len - off, "%c%u", CSV_SEPARATOR, s->sequence);
 
 	for (int i = 0; i < s->length; i++) {
-		switch ((s->format >> i) & 0x1) {
+		switch (sample_get_data_format(s, i)) {
 			case SAMPLE_DATA_FORMAT_FLOAT:
 				off += snprintf(buf + off, len - off, "%c%.6f", CSV_SEPARATOR, s->data[i].f);
 				break;
@@ -88,7 +88,7 @@ size_t csv_sscan_single(const char *buf, size_t len, struct sample *s, int flags
 		if (*end == '\n')
 			goto out;
 
-		switch (s->format & (1 << s->length)) {
+		switch (sample_get_data_format(s, s->length)) {
 			case SAMPLE_DATA_FORMAT_FLOAT:
 				s->data[s->length].f = strtod(ptr, &end);
 				break;
@@ -96,7 +96,7 @@ int raw_sprint(char *buf, size_t len, size_t *wbytes, struct sample *smps[], uns
 			enum { INT, FLT } fmt;
 
 			if      (flags & RAW_AUTO)
-				fmt = smps[i]->format & (1 << i) ? INT : FLT;
+				fmt = sample_get_data_format(smps[i], j) == SAMPLE_DATA_FORMAT_INT ? INT : FLT;
 			else if (flags & RAW_FLT)
 				fmt = FLT;
 			else
@@ -133,7 +133,7 @@ size_t villas_human_sscan_single(const char *buf, size_t len, struct sample *s,
 		if (*end == '\n')
 			break;
 
-		switch (s->format & (1 << s->length)) {
+		switch (sample_get_data_format(s, s->length)) {
 			case SAMPLE_DATA_FORMAT_FLOAT:
 				s->data[s->length].f = strtod(ptr, &end);
 				break;
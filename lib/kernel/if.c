@@ -191,6 +191,23 @@ int if_get_irqs(struct interface *i)
 	return 0;
 }
 
+int if_get_numa_node(struct interface *i)
+{
+	char filename[NAME_MAX];
+	FILE *file;
+	int ret, node;
+
+	snprintf(filename, sizeof(filename), "/sys/class/net/%s/device/numa_node", rtnl_link_get_name(i->nl_link));
+	file = fopen(filename, "r");
+	if (!file)
+		return -1;
+
+	ret = fscanf(file, "%d", &node);
+	fclose(file);
+
+	return ret == 1 ? node : -1;
+}
+
 int if_set_affinity(struct interface *i, int affinity)
 {
 	char filename[NAME_MAX];
@@ -25,6 +25,8 @@
 #include <time.h>
 #include <unistd.h>
 #include <fcntl.h>
+#include <dirent.h>
+#include <limits.h>
 
 #include <sys/types.h>
 #include <sys/utsname.h>
@@ -258,6 +260,56 @@ int kernel_has_cap(cap_value_t cap)
 }
 #endif
 
+/** Read a counter of the hugepages with a size of \p pagesz bytes. */
+static int kernel_get_hugepages_attr(size_t pagesz, const char *attr)
+{
+	char fn[256];
+	FILE *f;
+	int nr, ret;
+
+	snprintf(fn, sizeof(fn), "%s/kernel/mm/hugepages/hugepages-%zukB/%s", SYSFS_PATH, pagesz >> 10, attr);
+	f = fopen(fn, "r");
+	if (!f)
+		return -1; /* Page size is not supported */
+
+	ret = fscanf(f, "%d", &nr);
+	if (ret != 1)
+		nr = -1;
+
+	fclose(f);
+
+	return nr;
+}
+
+int kernel_get_nr_hugepages_size(size_t pagesz)
+{
+	return kernel_get_hugepages_attr(pagesz, "nr_hugepages");
+}
+
+int kernel_get_free_hugepages_size(size_t pagesz)
+{
+	return kernel_get_hugepages_attr(pagesz, "free_hugepages");
+}
+
+int kernel_set_nr_hugepages_size(size_t pagesz, int nr)
+{
+	char fn[256];
+	FILE *f;
+
+	snprintf(fn, sizeof(fn), "%s/kernel/mm/hugepages/hugepages-%zukB/nr_hugepages", SYSFS_PATH, pagesz >> 10);
+	f = fopen(fn, "w");
+	if (!f)
+		return -1;
+
+	fprintf(f, "%d\n", nr);
+	if (fclose(f))
+		return -1;
+
+	debug(LOG_KERNEL | 5, "Reserved %d hugepages of %zu kB", nr, pagesz >> 10);
+
+	return 0;
+}
+
 int kernel_irq_setaffinity(unsigned irq, uintmax_t new, uintmax_t *old)
 {
 	char fn[64];
@@ -279,4 +331,26 @@ int kernel_irq_setaffinity(unsigned irq, uintmax_t new, uintmax_t *old)
 	return ret;
 }
 
+int kernel_get_cpu_numa_node(int cpu)
+{
+	char dirname[NAME_MAX];
+	int node = -1;
+
+	/* The directory of each CPU contains a link named after its NUMA node */
+	snprintf(dirname, sizeof(dirname), SYSFS_PATH "/devices/system/cpu/cpu%d/", cpu);
+	DIR *dir = opendir(dirname);
+	if (!dir)
+		return -1;
+
+	struct dirent *entry;
+	while ((entry = readdir(dir))) {
+		if (sscanf(entry->d_name, "node%d", &node) == 1)
+			break;
+	}
+
+	closedir(dir);
+
+	return node;
+}
+
 #endif /* __linux__ */
@@ -21,8 +21,10 @@
  *********************************************************************************/
 
 #include <sched.h>
+#include <stdint.h>
 #include <unistd.h>
 #include <sys/mman.h>
+#include <sys/syscall.h>
 
 #include "config.h"
 #include "utils.h"
@@ -63,7 +65,72 @@ int rt_init(int priority, int affinity)
 	return 0;
 }
 
+int rt_init_thread(int priority, int affinity, struct rt_deadline *dl)
+{
 #ifdef __linux__
+	if (affinity)
+		rt_set_affinity(affinity);
+
+	if (dl && dl->runtime > 0) {
+		if (affinity)
+			warn("SCHED_DEADLINE requires an exclusive cpuset. Restricting the affinity of a thread will most likely fail.");
+
+		rt_set_deadline(dl);
+	}
+	else if (priority)
+		rt_set_priority(priority);
+#else
+	if (affinity || priority || (dl && dl->runtime > 0))
+		warn("Per-thread scheduling settings are not supported on this platform");
+#endif
+
+	return 0;
+}
+
+int rt_parse_deadline(struct rt_deadline *dl, json_t *cfg)
+{
+	int ret;
+	json_error_t err;
+
+	dl->deadline = 0;
+
+	ret = json_unpack_ex(cfg, &err, 0, "{ s: F, s: F, s?: F }",
+		"runtime", &dl->runtime,
+		"period", &dl->period,
+		"deadline", &dl->deadline
+	);
+	if (ret)
+		jerror(&err, "Failed to parse SCHED_DEADLINE settings");
+
+	if (dl->deadline == 0)
+		dl->deadline = dl->period;
+
+	if (dl->runtime <= 0 || dl->runtime > dl->deadline || dl->deadline > dl->period)
+		error("Invalid SCHED_DEADLINE settings: 0 < runtime <= deadline <= period is required");
+
+	return 0;
+}
+
+#ifdef __linux__
+
+#ifndef SCHED_DEADLINE
+  #define SCHED_DEADLINE	6
+#endif
+
+/** See sched_setattr(2). Not all C libraries provide a definition. */
+struct rt_sched_attr {
+	uint32_t size;
+
+	uint32_t sched_policy;
+	uint64_t sched_flags;
+
+	int32_t sched_nice;
+	uint32_t sched_priority;
+
+	uint64_t sched_runtime;
+	uint64_t sched_deadline;
+	uint64_t sched_period;
+};
 
 int rt_lock_memory()
 {
@@ -138,6 +205,26 @@ int rt_set_priority(int priority)
 	return 0;
 }
 
+int rt_set_deadline(struct rt_deadline *dl)
+{
+	int ret;
+	struct rt_sched_attr attr = {
+		.size = sizeof(attr),
+		.sched_policy = SCHED_DEADLINE,
+		.sched_runtime  = dl->runtime  * 1e9,
+		.sched_deadline = dl->deadline * 1e9,
+		.sched_period   = dl->period   * 1e9
+	};
+
+	ret = syscall(SYS_sched_setattr, 0, &attr, 0);
+	if (ret)
+		serror("Failed to set SCHED_DEADLINE scheduling policy");
+
+	debug(LOG_KERNEL | 3, "Task scheduled with SCHED_DEADLINE: runtime=%g, deadline=%g, period=%g", dl->runtime, dl->deadline, dl->period);
+
+	return 0;
+}
+
 int rt_is_preemptible()
 {
 	return access(SYSFS_PATH "/kernel/realtime", R_OK);
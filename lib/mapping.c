@@ -253,7 +253,7 @@ int mapping_update(struct mapping_entry *me, struct sample *remapped, struct sam
 			switch (me->stats.type) {
 				case MAPPING_STATS_TYPE_TOTAL:
 					sample_set_data_format(remapped, off, SAMPLE_DATA_FORMAT_INT);
-					remapped->data[off++].f = h->total;
+					remapped->data[off++].i = h->total;
 					break;
 				case MAPPING_STATS_TYPE_LAST:
 					remapped->data[off++].f = h->last;
@@ -276,6 +276,8 @@ int mapping_update(struct mapping_entry *me, struct sample *remapped, struct sam
 				default:
 					return -1;
 			}
+
+			break;
 		}
 
 		case MAPPING_TYPE_TS: {
@@ -361,3 +363,203 @@ int mapping_remap(struct list *m, struct sample *remapped, struct sample *origin
 
 	return 0;
 }
+
+int mapping_plan_init(struct mapping_plan *p, struct list *m, struct stats *s)
+{
+	assert(p->state == STATE_DESTROYED);
+
+	p->nsteps = 0;
+	p->length = 0;
+	p->steps = alloc(MAX(1, list_length(m)) * sizeof(struct mapping_step));
+
+	for (size_t i = 0; i < list_length(m); i++) {
+		struct mapping_entry *me = (struct mapping_entry *) list_at(m, i);
+		struct mapping_step *prev = p->nsteps > 0 ? &p->steps[p->nsteps - 1] : NULL;
+		struct mapping_step *st = &p->steps[p->nsteps];
+		struct stats *stats;
+
+		st->type = me->type;
+		st->offset = me->offset;
+		st->length = me->length;
+
+		switch (me->type) {
+			case MAPPING_TYPE_DATA:
+				/* Merge with the previous step if both ranges are contiguous */
+				if (prev && prev->type == MAPPING_TYPE_DATA && prev->length > 0 && me->length > 0 &&
+				    prev->offset + prev->length == me->offset &&
+				    prev->src + prev->length == me->data.offset) {
+					prev->length += me->length;
+					st = prev;
+				}
+				else
+					st->src = me->data.offset;
+				break;
+
+			case MAPPING_TYPE_STATS:
+				stats = s ? s : me->node ? me->node->stats : NULL;
+				if (!stats) {
+					warn("Statistic mapping of node %s requires the 'stats' hook", me->node ? node_name(me->node) : "?");
+					goto invalid;
+				}
+
+				st->length = 1;
+				st->stats.hist = &stats->histograms[me->stats.id];
+				st->stats.type = me->stats.type;
+				break;
+
+			case MAPPING_TYPE_HDR:
+				st->length = 1;
+				st->hdr = me->hdr.id;
+				break;
+
+			case MAPPING_TYPE_TS:
+				if (me->ts.id != MAPPING_TS_ORIGIN && me->ts.id != MAPPING_TS_RECEIVED)
+					goto invalid;
+
+				st->length = 2;
+				st->ts = me->ts.id;
+				break;
+
+			default:
+				goto invalid;
+		}
+
+		if (st->offset + st->length > p->length)
+			p->length = st->offset + st->length;
+
+		if (st != prev)
+			p->nsteps++;
+	}
+
+	debug(LOG_PATH | 10, "Compiled %zu mapping entries into %zu steps", list_length(m), p->nsteps);
+
+	p->state = STATE_INITIALIZED;
+
+	return 0;
+
+invalid:
+	free(p->steps);
+
+	return -1;
+}
+
+int mapping_plan_destroy(struct mapping_plan *p)
+{
+	if (p->state == STATE_DESTROYED)
+		return 0;
+
+	free(p->steps);
+
+	p->state = STATE_DESTROYED;
+
+	return 0;
+}
+
+/** Copy the number representation of \p len values of \p src starting at \p soff to \p dst starting at \p doff. */
+static void mapping_copy_format(struct sample *dst, int doff, struct sample *src, int soff, int len)
+{
+	/* Fast path: both ranges are covered by sample::format */
+	if (doff + len <= SAMPLE_FORMAT_INLINE && soff + len <= SAMPLE_FORMAT_INLINE) {
+		uint64_t mask = len < 64 ? (1ULL << len) - 1 : ~0ULL;
+		uint64_t bits = (src->format >> soff) & mask;
+
+		dst->format = (dst->format & ~(mask << doff)) | (bits << doff);
+	}
+	else {
+		for (int i = 0; i < len; i++)
+			sample_set_data_format(dst, doff + i, sample_get_data_format(src, soff + i));
+	}
+}
+
+int mapping_plan_remap(struct mapping_plan *p, struct sample *remapped, struct sample *original)
+{
+	/* We copy all the header fields */
+	remapped->sequence = original->sequence;
+	remapped->source   = original->source;
+	remapped->ts       = original->ts;
+	remapped->id       = original->id;
+
+	if (p->length > remapped->capacity)
+		return -1;
+
+	if (p->length > remapped->length)
+		remapped->length = p->length;
+
+	for (size_t i = 0; i < p->nsteps; i++) {
+		struct mapping_step *st = &p->steps[i];
+		struct hist *h;
+		struct timespec *ts;
+
+		int off = st->offset;
+		int len = st->length;
+
+		switch (st->type) {
+			case MAPPING_TYPE_DATA: {
+				int avail;
+
+				/* A length of 0 means that we want to take all values */
+				if (!len) {
+					len = original->length;
+
+					if (off + len > remapped->capacity)
+						return -1;
+
+					if (off + len > remapped->length)
+						remapped->length = off + len;
+				}
+
+				/* Values beyond the end of the original sample are zero */
+				avail = MAX(0, MIN(len, original->length - st->src));
+
+				memcpy(&remapped->data[off], &original->data[st->src], SAMPLE_DATA_LEN(avail));
+				mapping_copy_format(remapped, off, original, st->src, avail);
+
+				for (int j = avail; j < len; j++) {
+					sample_set_data_format(remapped, off + j, SAMPLE_DATA_FORMAT_FLOAT);
+					remapped->data[off + j].f = 0;
+				}
+
+				break;
+			}
+
+			case MAPPING_TYPE_STATS:
+				h = st->stats.hist;
+
+				sample_set_data_format(remapped, off, st->stats.type == MAPPING_STATS_TYPE_TOTAL ? SAMPLE_DATA_FORMAT_INT : SAMPLE_DATA_FORMAT_FLOAT);
+
+				switch (st->stats.type) {
+					case MAPPING_STATS_TYPE_TOTAL:   remapped->data[off].i = h->total;	break;
+					case MAPPING_STATS_TYPE_LAST:    remapped->data[off].f = h->last;	break;
+					case MAPPING_STATS_TYPE_HIGHEST: remapped->data[off].f = h->highest;	break;
+					case MAPPING_STATS_TYPE_LOWEST:  remapped->data[off].f = h->lowest;	break;
+					case MAPPING_STATS_TYPE_MEAN:    remapped->data[off].f = hist_mean(h);	break;
+					case MAPPING_STATS_TYPE_STDDEV:  remapped->data[off].f = hist_stddev(h);break;
+					case MAPPING_STATS_TYPE_VAR:     remapped->data[off].f = hist_var(h);	break;
+				}
+				break;
+
+			case MAPPING_TYPE_TS:
+				ts = st->ts == MAPPING_TS_ORIGIN ? &original->ts.origin : &original->ts.received;
+
+				sample_set_data_format(remapped, off,     SAMPLE_DATA_FORMAT_INT);
+				sample_set_data_format(remapped, off + 1, SAMPLE_DATA_FORMAT_INT);
+
+				remapped->data[off].i     = ts->tv_sec;
+				remapped->data[off + 1].i = ts->tv_nsec;
+				break;
+
+			case MAPPING_TYPE_HDR:
+				sample_set_data_format(remapped, off, SAMPLE_DATA_FORMAT_INT);
+
+				switch (st->hdr) {
+					case MAPPING_HDR_LENGTH:   remapped->data[off].i = original->length;	break;
+					case MAPPING_HDR_SEQUENCE: remapped->data[off].i = original->sequence;	break;
+					case MAPPING_HDR_ID:       remapped->data[off].i = original->id;	break;
+					case MAPPING_HDR_FORMAT:   remapped->data[off].i = original->format;	break;
+				}
+				break;
+		}
+	}
+
+	return 0;
+}
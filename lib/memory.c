@@ -24,23 +24,36 @@
 #include <unistd.h>
 #include <errno.h>
 #include <strings.h>
+#include <pthread.h>
 
 #include <sys/mman.h>
 #include <sys/time.h>
 #include <sys/resource.h>
 #include <sys/types.h>
+#include <sys/syscall.h>
 
 /* Required to allocate hugepages on Apple OS X */
 #ifdef __MACH__
   #include <mach/vm_statistics.h>
 #elif defined(__linux__)
+  #include <linux/mempolicy.h>
+
   #include "kernel/kernel.h"
 #endif
 
+#include "config.h"
 #include "log.h"
 #include "memory.h"
 #include "utils.h"
 
+void * memory_managed_alloc(struct memtype *m, size_t len, size_t alignment);
+int memory_managed_free(struct memtype *m, void *ptr, size_t len);
+
+/** The arena which serves all allocations of memtype_hugepage after memory_arena_init() */
+static struct memtype *memory_arena = NULL;
+static size_t memory_arena_len;
+static pthread_mutex_t memory_arena_mutex = PTHREAD_MUTEX_INITIALIZER;
+
 int memory_init(int hugepages)
 {
 #ifdef __linux__
@@ -129,6 +142,22 @@ static void * memory_hugepage_alloc(struct memtype *m, size_t len, size_t alignm
 	int prot = PROT_READ | PROT_WRITE;
 	int flags = MAP_PRIVATE | MAP_ANONYMOUS;
 
+	if (memory_arena) {
+		pthread_mutex_lock(&memory_arena_mutex);
+		ret = memory_managed_alloc(memory_arena, len, MAX(alignment, MEMORY_ARENA_ALIGN));
+		pthread_mutex_unlock(&memory_arena_mutex);
+
+		if (ret)
+			return ret;
+
+		/* The arena has been sized by the footprint callbacks of all nodes and paths.
+		 * Mapping the allocation separately would fault in pages at runtime. */
+		warn("Hugepage arena is exhausted. Failed to allocate %#zx bytes", len);
+
+		errno = ENOMEM;
+		return NULL;
+	}
+
 #ifdef __MACH__
 	flags |= VM_FLAGS_SUPERPAGE_SIZE_2MB;
 #elif defined(__linux__)
@@ -147,141 +176,297 @@ static void * memory_hugepage_alloc(struct memtype *m, size_t len, size_t alignm
 
 static int memory_hugepage_free(struct memtype *m, void *ptr, size_t len)
 {
+	int ret;
+
+	if (memory_arena && (char *) ptr >= (char *) memory_arena && (char *) ptr < (char *) memory_arena + memory_arena_len) {
+		pthread_mutex_lock(&memory_arena_mutex);
+		ret = memory_managed_free(memory_arena, ptr, len);
+		pthread_mutex_unlock(&memory_arena_mutex);
+
+		return ret;
+	}
+
 	len = ALIGN(len, HUGEPAGESIZE); /* ugly see: https://lkml.org/lkml/2015/3/27/171 */
 
 	return munmap(ptr, len);
 }
 
-void* memory_managed_alloc(struct memtype *m, size_t len, size_t alignment)
+#ifdef __linux__
+/** Allocate hugepages and bind them to the NUMA node in memtype::_vd */
+static void * memory_numa_alloc(struct memtype *m, size_t len, size_t alignment)
 {
-	/* Simple first-fit allocation */
-	struct memblock *first = (struct memblock *) m->_vd;
-	struct memblock *block;
+	int ret;
+	void *ptr;
+	int node = (intptr_t) m->_vd;
+	unsigned long nodemask = 1UL << node;
+
+	/* The pages must not be faulted in (MAP_LOCKED) before the policy is set */
+	ptr = mmap(NULL, len, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+	if (ptr == MAP_FAILED)
+		return NULL;
 
-	for (block = first; block != NULL; block = block->next) {
-		if (block->flags & MEMBLOCK_USED)
-			continue;
-
-		char* cptr = (char *) block + sizeof(struct memblock);
-		size_t avail = block->len;
-		uintptr_t uptr = (uintptr_t) cptr;
-
-		/* Check alignment first; leave a gap at start of block to assure
-		 * alignment if necessary */
-		uintptr_t rem = uptr % alignment;
-		uintptr_t gap = 0;
-		if (rem != 0) {
-			gap = alignment - rem;
-			if (gap > avail)
-				continue; /* Next aligned address isn't in this block anymore */
-
-			cptr += gap;
-			avail -= gap;
+	ret = syscall(SYS_mbind, ptr, ALIGN(len, HUGEPAGESIZE), MPOL_PREFERRED, &nodemask, sizeof(nodemask) * 8, 0);
+	if (ret)
+		warn("Failed to bind %#zx bytes of memory to NUMA node %d: %s", len, node, strerror(errno));
+
+	if (getuid() == 0) {
+		ret = mlock(ptr, len);
+		if (ret)
+			warn("Failed to lock %#zx bytes of memory: %s", len, strerror(errno));
+	}
+
+	return ptr;
+}
+#endif
+
+struct memtype * memtype_numa(int node)
+{
+#ifdef __linux__
+	static struct memtype types[NUMA_MAX_NODES];
+
+	if (node >= 0 && node < NUMA_MAX_NODES) {
+		struct memtype *m = &types[node];
+
+		/* Memory types are initialized on first use and never released */
+		if (!m->alloc) {
+			m->name = "mmap_hugepages_numa";
+			m->flags = MEMORY_MMAP | MEMORY_HUGEPAGE;
+			m->free = memory_hugepage_free;
+			m->alignment = 21; /* 2 MiB hugepage */
+			m->_vd = (void *) (intptr_t) node;
+			m->alloc = memory_numa_alloc;
 		}
 
-		if (avail >= len) {
-			if (gap > sizeof(struct memblock)) {
-				/* The alignment gap is big enough to fit another block.
-				 * The original block descriptor is already at the correct
-				 * position, so we just change its len and create a new block
-				 * descriptor for the actual block we're handling. */
-				block->len = gap - sizeof(struct memblock);
-				struct memblock *newblock = (struct memblock *) (cptr - sizeof(struct memblock));
-				newblock->prev = block;
-				newblock->next = block->next;
-				block->next = newblock;
-				newblock->flags = 0;
-				newblock->len = len;
-				block = newblock;
-			}
-			else {
-				/* The gap is too small to fit another block descriptor, so we
-				 * must account for the gap length in the block length. */
-				block->len = len + gap;
-			}
-
-			if (avail > len + sizeof(struct memblock)) {
-				/* Imperfect fit, so create another block for the remaining part */
-				struct memblock *newblock = (struct memblock *) (cptr + len);
-				newblock->prev = block;
-				newblock->next = block->next;
-				block->next = newblock;
-				if (newblock->next)
-					newblock->next->prev = newblock;
-				newblock->flags = 0;
-				newblock->len = avail - len - sizeof(struct memblock);
-			}
-			else {
-				/* If this block was larger than the requested length, but only
-				 * by less than sizeof(struct memblock), we may have wasted
-				 * memory by previous assignments to block->len. */
-				block->len = avail;
-			}
-
-			block->flags |= MEMBLOCK_USED;
-
-			return (void *) cptr;
+		return m;
+	}
+#endif
+
+	return &memtype_hugepage;
+}
+
+/** Free blocks store the links of their size class list in their payload. */
+struct memblock_links {
+	off_t next;
+	off_t prev;
+};
+
+/** Smallest block which can be split off: a descriptor and the links of a free block. */
+#define MEMBLOCK_MIN	(sizeof(struct memblock) + sizeof(struct memblock_links))
+
+/** The manager is placed directly after the memtype. It is not referenced by an absolute pointer,
+ * so that the region can be mapped at different addresses by multiple processes. */
+#define MEMORY_MANAGER(m)	((struct memmanager *) ((char *) (m) + ALIGN(sizeof(struct memtype), MEMBLOCK_ALIGN)))
+
+#define MEMBLOCK_LEN(b)		((b)->len & ~(size_t) (MEMBLOCK_ALIGN - 1))
+#define MEMBLOCK_OFF(m, b)	((off_t) ((char *) (b) - (char *) (m)))
+#define MEMBLOCK_AT(m, off)	((struct memblock *) ((char *) (m) + (off)))
+#define MEMBLOCK_LINKS(b)	((struct memblock_links *) ((char *) (b) + sizeof(struct memblock)))
+
+/** The size class of a free block of length \p len: floor(log2(len)) */
+static int memory_managed_class(size_t len)
+{
+	int cls = sizeof(unsigned long) * 8 - 1 - __builtin_clzl(len);
+
+	return MIN(cls, MEMBLOCK_CLASSES - 1);
+}
+
+static struct memblock * memory_managed_next(struct memtype *m, struct memblock *b)
+{
+	struct memmanager *mm = MEMORY_MANAGER(m);
+	char *next = (char *) b + sizeof(struct memblock) + MEMBLOCK_LEN(b);
+
+	return next < (char *) m + mm->len ? (struct memblock *) next : NULL;
+}
+
+static struct memblock * memory_managed_prev(struct memtype *m, struct memblock *b)
+{
+	return b->prev ? (struct memblock *) ((char *) b - b->prev - sizeof(struct memblock)) : NULL;
+}
+
+static void memory_managed_insert(struct memtype *m, struct memblock *b)
+{
+	struct memmanager *mm = MEMORY_MANAGER(m);
+	struct memblock_links *l = MEMBLOCK_LINKS(b);
+	int cls = memory_managed_class(MEMBLOCK_LEN(b));
+
+	l->prev = 0;
+	l->next = mm->free[cls];
+
+	if (l->next)
+		MEMBLOCK_LINKS(MEMBLOCK_AT(m, l->next))->prev = MEMBLOCK_OFF(m, b);
+
+	mm->free[cls] = MEMBLOCK_OFF(m, b);
+	mm->classes |= 1ULL << cls;
+}
+
+static void memory_managed_unlink(struct memtype *m, struct memblock *b)
+{
+	struct memmanager *mm = MEMORY_MANAGER(m);
+	struct memblock_links *l = MEMBLOCK_LINKS(b);
+	int cls = memory_managed_class(MEMBLOCK_LEN(b));
+
+	if (l->prev)
+		MEMBLOCK_LINKS(MEMBLOCK_AT(m, l->prev))->next = l->next;
+	else
+		mm->free[cls] = l->next;
+
+	if (l->next)
+		MEMBLOCK_LINKS(MEMBLOCK_AT(m, l->next))->prev = l->prev;
+
+	if (!mm->free[cls])
+		mm->classes &= ~(1ULL << cls);
+}
+
+/** Split block \p b after \p len bytes of payload. The remainder becomes a new free block. */
+static void memory_managed_split(struct memtype *m, struct memblock *b, size_t len)
+{
+	size_t rest = MEMBLOCK_LEN(b) - len;
+
+	if (rest < MEMBLOCK_MIN)
+		return;
+
+	struct memblock *r = (struct memblock *) ((char *) b + sizeof(struct memblock) + len);
+
+	r->prev = len;
+	r->len = rest - sizeof(struct memblock);
+
+	b->len = len | (b->len & MEMBLOCK_USED);
+
+	struct memblock *n = memory_managed_next(m, r);
+	if (n)
+		n->prev = MEMBLOCK_LEN(r);
+
+	memory_managed_insert(m, r);
+}
+
+/** Find a free block with at least \p len bytes of payload and remove it from its list. */
+static struct memblock * memory_managed_find(struct memtype *m, size_t len)
+{
+	struct memmanager *mm = MEMORY_MANAGER(m);
+	int cls = memory_managed_class(len);
+
+	/* Every block of a higher class fits */
+	uint64_t higher = cls + 1 < MEMBLOCK_CLASSES ? mm->classes & ~((2ULL << cls) - 1) : 0;
+	if (higher) {
+		struct memblock *b = MEMBLOCK_AT(m, mm->free[__builtin_ctzll(higher)]);
+
+		memory_managed_unlink(m, b);
+
+		return b;
+	}
+
+	/* Blocks of the same class may be too small */
+	for (off_t off = mm->free[cls]; off; off = MEMBLOCK_LINKS(MEMBLOCK_AT(m, off))->next) {
+		struct memblock *b = MEMBLOCK_AT(m, off);
+
+		if (MEMBLOCK_LEN(b) >= len) {
+			memory_managed_unlink(m, b);
+
+			return b;
 		}
 	}
 
-	/* No suitable block found */
 	return NULL;
 }
 
-int memory_managed_free(struct memtype *m, void *ptr, size_t len)
+void * memory_managed_alloc(struct memtype *m, size_t len, size_t alignment)
 {
-	struct memblock *first = (struct memblock *) m->_vd;
+	size_t need;
 	struct memblock *block;
-	char *cptr = ptr;
 
-	for (block = first; block != NULL; block = block->next) {
-		if (!(block->flags & MEMBLOCK_USED))
-			continue;
-
-		/* Since we may waste some memory at the start of a block to ensure
-		 * alignment, ptr may not actually be the start of the block */
-		if ((char *) block + sizeof(struct memblock) <= cptr &&
-		    cptr < (char *) block + sizeof(struct memblock) + block->len) {
-			/* Try to merge it with neighbouring free blocks */
-			if (block->prev && !(block->prev->flags & MEMBLOCK_USED) &&
-			    block->next && !(block->next->flags & MEMBLOCK_USED)) {
-				/* Special case first: both previous and next block are unused */
-				block->prev->len += block->len + block->next->len + 2 * sizeof(struct memblock);
-				block->prev->next = block->next->next;
-				if (block->next->next)
-					block->next->next->prev = block->prev;
-			}
-			else if (block->prev && !(block->prev->flags & MEMBLOCK_USED)) {
-				block->prev->len += block->len + sizeof(struct memblock);
-				block->prev->next = block->next;
-				if (block->next)
-					block->next->prev = block->prev;
-			}
-			else if (block->next && !(block->next->flags & MEMBLOCK_USED)) {
-				block->len += block->next->len + sizeof(struct memblock);
-				block->next = block->next->next;
-				if (block->next)
-					block->next->prev = block;
-			}
-			else {
-				/* no neighbouring free block, so just mark it as free */
-				block->flags &= ~MEMBLOCK_USED;
-			}
-
-			return 0;
-		}
+	len = ALIGN(MAX(len, sizeof(struct memblock_links)), MEMBLOCK_ALIGN);
+
+	/* Payloads are always aligned to MEMBLOCK_ALIGN. For larger alignments
+	 * we reserve space for a leading gap which can be split off as a separate block */
+	need = alignment > MEMBLOCK_ALIGN
+		? len + alignment - MEMBLOCK_ALIGN + MEMBLOCK_MIN
+		: len;
+
+	block = memory_managed_find(m, need);
+	if (!block)
+		return NULL; /* No suitable block found */
+
+	char *cptr = (char *) block + sizeof(struct memblock);
+
+	if (!IS_ALIGNED(cptr, alignment)) {
+		char *aligned = (char *) ALIGN(cptr, alignment);
+
+		/* The gap must be large enough to hold a free block */
+		if (aligned - cptr < MEMBLOCK_MIN)
+			aligned += alignment;
+
+		struct memblock *newblock = (struct memblock *) (aligned - sizeof(struct memblock));
+
+		newblock->prev = (char *) newblock - cptr;
+		newblock->len = MEMBLOCK_LEN(block) - newblock->prev - sizeof(struct memblock);
+
+		block->len = newblock->prev;
+
+		struct memblock *n = memory_managed_next(m, newblock);
+		if (n)
+			n->prev = MEMBLOCK_LEN(newblock);
+
+		memory_managed_insert(m, block);
+
+		block = newblock;
+		cptr = aligned;
 	}
 
-	return -1;
+	memory_managed_split(m, block, len);
+
+	block->len |= MEMBLOCK_USED;
+
+	return (void *) cptr;
+}
+
+int memory_managed_free(struct memtype *m, void *ptr, size_t len)
+{
+	struct memmanager *mm = MEMORY_MANAGER(m);
+	struct memblock *block, *prev, *next;
+
+	if ((char *) ptr < (char *) mm + sizeof(struct memmanager) + sizeof(struct memblock) ||
+	    (char *) ptr >= (char *) m + mm->len)
+		return -1;
+
+	block = (struct memblock *) ((char *) ptr - sizeof(struct memblock));
+	if (!(block->len & MEMBLOCK_USED))
+		return -1;
+
+	block->len &= ~MEMBLOCK_USED;
+
+	/* Try to merge it with neighbouring free blocks */
+	next = memory_managed_next(m, block);
+	if (next && !(next->len & MEMBLOCK_USED)) {
+		memory_managed_unlink(m, next);
+
+		block->len += sizeof(struct memblock) + MEMBLOCK_LEN(next);
+	}
+
+	prev = memory_managed_prev(m, block);
+	if (prev && !(prev->len & MEMBLOCK_USED)) {
+		memory_managed_unlink(m, prev);
+
+		prev->len += sizeof(struct memblock) + MEMBLOCK_LEN(block);
+		block = prev;
+	}
+
+	next = memory_managed_next(m, block);
+	if (next)
+		next->prev = MEMBLOCK_LEN(block);
+
+	memory_managed_insert(m, block);
+
+	return 0;
 }
 
 struct memtype * memtype_managed_init(void *ptr, size_t len)
 {
 	struct memtype *mt = ptr;
+	struct memmanager *mm;
 	struct memblock *mb;
 	char *cptr = ptr;
 
-	if (len < sizeof(struct memtype) + sizeof(struct memblock)) {
+	if (len < sizeof(struct memtype) + sizeof(struct memmanager) + MEMBLOCK_MIN) {
 		info("memtype_managed_init: passed region too small");
 		return NULL;
 	}
@@ -293,23 +478,130 @@ struct memtype * memtype_managed_init(void *ptr, size_t len)
 	mt->free  = memory_managed_free;
 	mt->alignment = 1;
 
-	cptr += ALIGN(sizeof(struct memtype), sizeof(void *));
+	mt->_vd = NULL;
+
+	cptr += ALIGN(sizeof(struct memtype), MEMBLOCK_ALIGN);
+
+	/* Initialize the free lists */
+	mm = MEMORY_MANAGER(mt);
+	mm->classes = 0;
+
+	for (int i = 0; i < MEMBLOCK_CLASSES; i++)
+		mm->free[i] = 0;
+
+	cptr += ALIGN(sizeof(struct memmanager), MEMBLOCK_ALIGN);
 
-	/* Initialize first free memblock */
+	/* Initialize first free memblock which spans the whole region */
 	mb = (struct memblock *) cptr;
-	mb->prev = NULL;
-	mb->next = NULL;
-	mb->flags = 0;
+	mb->prev = 0;
 
-	cptr += ALIGN(sizeof(struct memblock), sizeof(void *));
+	cptr += sizeof(struct memblock);
 
-	mb->len = len - (cptr - (char *) ptr);
+	mb->len = (len - (cptr - (char *) ptr)) & ~(size_t) (MEMBLOCK_ALIGN - 1);
 
-	mt->_vd = (void *) mb;
+	mm->len = (cptr - (char *) ptr) + mb->len;
+
+	memory_managed_insert(mt, mb);
 
 	return mt;
 }
 
+size_t memory_footprint(size_t len, size_t alignment)
+{
+	alignment = MAX(alignment, MEMORY_ARENA_ALIGN);
+
+	/* The descriptor, the payload and the largest gap which memory_managed_alloc() may leave for alignment */
+	return sizeof(struct memblock)
+		+ ALIGN(MAX(len, sizeof(struct memblock_links)), MEMBLOCK_ALIGN)
+		+ alignment + MEMBLOCK_ALIGN;
+}
+
+int memory_arena_init(size_t len, size_t pagesz)
+{
+#ifdef __linux__
+	int ret, pages, avail, nr;
+	void *ptr;
+	struct rlimit l;
+
+	assert(memory_arena == NULL);
+
+	/* The arena starts with the headers of memtype_managed */
+	len = ALIGN(len + sizeof(struct memtype) + sizeof(struct memmanager) + MEMBLOCK_ALIGN, pagesz);
+	pages = len / pagesz;
+
+	info("Reserving hugepage arena: size=%zu bytes, #pages=%d, pagesize=%zu kB", len, pages, pagesz >> 10);
+
+	avail = kernel_get_free_hugepages_size(pagesz);
+	if (avail < 0) {
+		warn("The kernel does not support hugepages with a size of %zu kB", pagesz >> 10);
+		return -1;
+	}
+
+	if (avail < pages) {
+		nr = kernel_get_nr_hugepages_size(pagesz);
+
+		ret = kernel_set_nr_hugepages_size(pagesz, nr + pages - avail);
+		if (ret)
+			warn("Failed to reserve %d additional hugepages of %zu kB", pages - avail, pagesz >> 10);
+
+		avail = kernel_get_free_hugepages_size(pagesz);
+		if (avail < pages) {
+			warn("The arena requires %zu bytes (%d hugepages of %zu kB), but only %d hugepages are available",
+				len, pages, pagesz >> 10, avail);
+			return -1;
+		}
+	}
+
+	ret = getrlimit(RLIMIT_MEMLOCK, &l);
+	if (ret)
+		return ret;
+
+	if (l.rlim_cur != RLIM_INFINITY && l.rlim_cur < len) {
+		l.rlim_cur = l.rlim_cur + len;
+		l.rlim_max = MAX(l.rlim_max, l.rlim_cur);
+
+		ret = setrlimit(RLIMIT_MEMLOCK, &l);
+		if (ret)
+			warn("Failed to increase ressource limit of locked memory to %ju bytes", (uintmax_t) l.rlim_cur);
+	}
+
+	/* All pages of the arena are faulted in right now */
+	int flags = MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | MAP_POPULATE | (__builtin_ctzl(pagesz) << MAP_HUGE_SHIFT);
+
+	if (getuid() == 0)
+		flags |= MAP_LOCKED;
+
+	ptr = mmap(NULL, len, PROT_READ | PROT_WRITE, flags, -1, 0);
+	if (ptr == MAP_FAILED) {
+		warn("Failed to map %zu bytes of hugepages for the arena: %s", len, strerror(errno));
+		return -1;
+	}
+
+	memory_arena = memtype_managed_init(ptr, len);
+	memory_arena_len = len;
+
+	return 0;
+#else
+	return -1;
+#endif
+}
+
+int memory_arena_destroy()
+{
+	int ret;
+
+	if (!memory_arena)
+		return 0;
+
+	ret = munmap(memory_arena, memory_arena_len);
+	if (ret)
+		return ret;
+
+	memory_arena = NULL;
+
+	return 0;
+}
+
 /* List of available memory types */
 struct memtype memtype_heap = {
 	.name = "heap",
@@ -21,6 +21,8 @@
  *********************************************************************************/
 
 #include <string.h>
+#include <strings.h>
+#include <poll.h>
 
 #include "sample.h"
 #include "node.h"
@@ -30,6 +32,7 @@
 #include "config_helper.h"
 #include "mapping.h"
 #include "timing.h"
+#include "kernel/kernel.h"
 
 int node_init(struct node *n, struct node_type *vt)
 {
@@ -51,6 +54,10 @@ int node_init(struct node *n, struct node_type *vt)
 	/* Default values */
 	n->vectorize = 1;
 	n->samplelen = DEFAULT_SAMPLELEN;
+	n->affinity = 0;
+	n->priority = 0;
+	n->deadline.runtime = 0;
+	n->numa_node = -1;
 
 	list_push(&vt->instances, n);
 
@@ -96,20 +103,31 @@ int node_parse(struct node *n, json_t *cfg, const char *name)
 
 	json_error_t err;
 	json_t *json_hooks = NULL;
+	json_t *json_deadline = NULL;
 
 	const char *type;
 
 	n->name = strdup(name);
 
-	ret = json_unpack_ex(cfg, &err, 0, "{ s: s, s?: i, s?: i, s?: o }",
+	ret = json_unpack_ex(cfg, &err, 0, "{ s: s, s?: i, s?: i, s?: o, s?: i, s?: i, s?: o, s?: i }",
 		"type", &type,
 		"vectorize", &n->vectorize,
 		"samplelen", &n->samplelen,
-		"hooks", &json_hooks
+		"hooks", &json_hooks,
+		"affinity", &n->affinity,
+		"priority", &n->priority,
+		"deadline", &json_deadline,
+		"numa_node", &n->numa_node
 	);
 	if (ret)
 		jerror(&err, "Failed to parse node '%s'", node_name(n));
 
+	if (json_deadline) {
+		ret = rt_parse_deadline(&n->deadline, json_deadline);
+		if (ret)
+			error("Failed to parse deadline settings of node '%s'", node_name(n));
+	}
+
 	p = plugin_lookup(PLUGIN_TYPE_NODE, type);
 	assert(&p->node == n->_vt);
 
@@ -166,6 +184,10 @@ int node_check(struct node *n)
 		error("Invalid value for `vectorize`. Node type requires a number smaller than %d!",
 			n->_vt->vectorize);
 
+	/* Place buffers next to the first CPU the node is pinned to */
+	if (n->numa_node < 0 && n->affinity)
+		n->numa_node = kernel_get_cpu_numa_node(ffs(n->affinity) - 1);
+
 	n->state = STATE_CHECKED;
 
 	return 0;
@@ -313,13 +335,51 @@ int node_read(struct node *n, struct sample *smps[], unsigned cnt)
 	return rread;
 }
 
+/** Write hooks modify samples in-place: replace shared samples by private copies (copy-on-write) */
+static int node_unshare(struct node *n, struct sample *smps[], unsigned cnt)
+{
+	int has_write_hooks = 0;
+
+	for (size_t i = 0; i < list_length(&n->hooks); i++) {
+		struct hook *h = (struct hook *) list_at(&n->hooks, i);
+
+		if (h->_vt->write)
+			has_write_hooks = 1;
+	}
+
+	if (!has_write_hooks)
+		return 0;
+
+	for (int i = 0; i < cnt; i++) {
+		struct sample *cpy;
+
+		if (atomic_load(&smps[i]->refcnt) <= 1)
+			continue;
+
+		cpy = sample_clone(smps[i]);
+		if (!cpy)
+			return -1;
+
+		sample_put(smps[i]);
+		smps[i] = cpy;
+	}
+
+	return 0;
+}
+
 int node_write(struct node *n, struct sample *smps[], unsigned cnt)
 {
-	int sent, nsent = 0;
+	int ret, sent, nsent = 0;
 
 	if (!n->_vt->write)
 		return -1;
 
+	ret = node_unshare(n, smps, cnt);
+	if (ret) {
+		warn("Pool underrun for node %s", node_name(n));
+		return ret;
+	}
+
 	/* Run write hooks */
 	cnt = hook_write_list(&n->hooks, smps, cnt);
 	if (cnt <= 0)
@@ -361,7 +421,7 @@ char * node_name_long(struct node *n)
 		if (n->_vt->print) {
 			struct node_type *vt = n->_vt;
 			char *name_long = vt->print(n);
-			strcatf(&n->_name_long, "%s: #hooks=%zu, id=%d, vectorize=%d, samplelen=%d, %s", node_name(n), list_length(&n->hooks), n->id, n->vectorize, n->samplelen, name_long);
+			strcatf(&n->_name_long, "%s: #hooks=%zu, id=%d, vectorize=%d, samplelen=%d, numa_node=%d, %s", node_name(n), list_length(&n->hooks), n->id, n->vectorize, n->samplelen, n->numa_node, name_long);
 			free(name_long);
 		}
 		else
@@ -386,6 +446,38 @@ int node_fd(struct node *n)
 	return n->_vt->fd ? n->_vt->fd(n) : -1;
 }
 
+size_t node_footprint(struct node *n)
+{
+	return n->_vt->footprint ? n->_vt->footprint(n) : 0;
+}
+
+int node_available(struct node *n)
+{
+	int ret;
+
+	if (n->_vt->available)
+		return n->_vt->available(n);
+
+	struct pollfd pfd = {
+		.fd = node_fd(n),
+		.events = POLLIN
+	};
+
+	if (pfd.fd < 0)
+		return -1;
+
+	ret = poll(&pfd, 1, 0);
+	if (ret < 0)
+		return ret;
+
+	return ret > 0 && (pfd.revents & POLLIN);
+}
+
+int node_poll_error(struct node *n)
+{
+	return n->_vt->poll_error ? n->_vt->poll_error(n) : -1;
+}
+
 int node_parse_list(struct list *list, json_t *cfg, struct list *all)
 {
 	struct node *node;
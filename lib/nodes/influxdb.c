@@ -20,6 +20,7 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  *********************************************************************************/
 
+#include <errno.h>
 #include <string.h>
 
 #include "node.h"
@@ -28,6 +29,9 @@
 #include "nodes/influxdb.h"
 #include "memory.h"
 
+/** The number of entries of the submission queue if io_uring is enabled. */
+#define INFLUXDB_URING_DEPTH 8
+
 int influxdb_parse(struct node *n, json_t *cfg)
 {
 	struct influxdb *i = (struct influxdb *) n->_vd;
@@ -39,14 +43,22 @@ int influxdb_parse(struct node *n, json_t *cfg)
 	char *tmp, *host, *port;
 	const char *server, *key;
 
-	ret = json_unpack_ex(cfg, &err, 0, "{ s: s, s: s, s?: o }",
+	i->io_uring = 0;
+
+	ret = json_unpack_ex(cfg, &err, 0, "{ s: s, s: s, s?: o, s?: b }",
 		"server", &server,
 		"key", &key,
-		"fields", &json_fields
+		"fields", &json_fields,
+		"io_uring", &i->io_uring
 	);
 	if (ret)
 		jerror(&err, "Failed to parse configuration of node %s", node_name(n));
 
+#ifndef WITH_LIBURING
+	if (i->io_uring)
+		error("Setting 'io_uring' of node %s requires VILLASnode to be built with liburing", node_name(n));
+#endif /* WITH_LIBURING */
+
 	tmp = strdup(server);
 
 	host = strtok(tmp, ":");
@@ -116,6 +128,16 @@ int influxdb_open(struct node *n)
 		break;
 	}
 
+#ifdef WITH_LIBURING
+	if (p && i->io_uring) {
+		ret = uring_init(&i->uring, INFLUXDB_URING_DEPTH);
+		if (ret)
+			serror("Failed to setup io_uring for node %s", node_name(n));
+
+		i->pending = NULL;
+	}
+#endif /* WITH_LIBURING */
+
 	return p ? 0 : -1;
 }
 
@@ -123,6 +145,16 @@ int influxdb_close(struct node *n)
 {
 	struct influxdb *i = (struct influxdb *) n->_vd;
 
+#ifdef WITH_LIBURING
+	/* influxdb_open() might have failed before the ring was set up */
+	if (i->io_uring && i->uring.state != STATE_DESTROYED) {
+		uring_destroy(&i->uring);
+
+		free(i->pending);
+		i->pending = NULL;
+	}
+#endif /* WITH_LIBURING */
+
 	close(i->sd);
 
 	list_destroy(&i->fields, NULL, true);
@@ -168,6 +200,34 @@ int influxdb_write(struct node *n, struct sample *smps[], unsigned cnt)
 	}
 
 	buflen = strlen(buf) + 1;
+
+#ifdef WITH_LIBURING
+	/* Do not wait for the send to complete. The buffer is released by the next call. */
+	if (i->io_uring) {
+		int ret;
+		struct io_uring_sqe *sqe;
+
+		ret = uring_wait(&i->uring);
+		if (ret)
+			warn("Failed to send to node %s: %s", node_name(n), strerror(errno));
+
+		free(i->pending);
+		i->pending = buf;
+
+		sqe = uring_get_sqe(&i->uring);
+		if (!sqe)
+			return -1;
+
+		io_uring_prep_send(sqe, i->sd, buf, buflen, 0);
+
+		ret = uring_submit(&i->uring);
+		if (ret < 0)
+			return -1;
+
+		return cnt;
+	}
+#endif /* WITH_LIBURING */
+
 	sentlen = send(i->sd, buf, buflen, 0);
 	if (sentlen < 0)
 		return -1;
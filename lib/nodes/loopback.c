@@ -35,9 +35,11 @@ int loopback_parse(struct node *n, json_t *cfg)
 
 	/* Default values */
 	l->queuelen = DEFAULT_QUEUELEN;
+	l->spin = 0;
 
-	ret = json_unpack_ex(cfg, &err, 0, "{ s?: i }",
-		"queuelen", &l->queuelen
+	ret = json_unpack_ex(cfg, &err, 0, "{ s?: i, s?: i }",
+		"queuelen", &l->queuelen,
+		"spin", &l->spin
 	);
 	if (ret)
 		jerror(&err, "Failed to parse configuration of node %s", node_name(n));
@@ -54,6 +56,17 @@ int loopback_open(struct node *n)
 	if (ret)
 		return ret;
 
+	/* Adaptive queues have no file descriptor. They must be read by a pipelined or polling path. */
+	if (l->spin > 0) {
+		ret = queue_signalled_init(&l->queue, l->queuelen, &memtype_hugepage, QUEUE_SIGNALLED_ADAPTIVE);
+		if (ret)
+			return ret;
+
+		l->queue.adaptive.spin = l->spin;
+
+		return 0;
+	}
+
 	return queue_signalled_init(&l->queue, l->queuelen, &memtype_hugepage, QUEUE_SIGNALLED_EVENTFD);
 }
 
@@ -107,7 +120,7 @@ char * loopback_print(struct node *n)
 	struct loopback *l = (struct loopback *) n->_vd;
 	char *buf = NULL;
 
-	strcatf(&buf, "queuelen=%d", l->queuelen);
+	strcatf(&buf, "queuelen=%d, spin=%d", l->queuelen, l->spin);
 
 	return buf;
 }
@@ -119,6 +132,20 @@ int loopback_fd(struct node *n)
 	return queue_signalled_fd(&l->queue);
 }
 
+int loopback_available(struct node *n)
+{
+	struct loopback *l = (struct loopback *) n->_vd;
+
+	return queue_signalled_available(&l->queue);
+}
+
+size_t loopback_footprint(struct node *n)
+{
+	struct loopback *l = (struct loopback *) n->_vd;
+
+	return pool_footprint(l->queuelen, SAMPLE_LEN(n->samplelen), 0) + queue_footprint(l->queuelen);
+}
+
 static struct plugin p = {
 	.name = "loopback",
 	.description = "Loopback to connect multiple paths",
@@ -132,7 +159,9 @@ static struct plugin p = {
 		.stop	= loopback_close,
 		.read	= loopback_read,
 		.write	= loopback_write,
-		.fd	= loopback_fd
+		.fd	= loopback_fd,
+		.available = loopback_available,
+		.footprint = loopback_footprint
 	}
 };
 
@@ -49,13 +49,15 @@ int shmem_parse(struct node *n, json_t *cfg)
 	shm->conf.queuelen = MAX(DEFAULT_SHMEM_QUEUELEN, n->vectorize);
 	shm->conf.samplelen = n->samplelen;
 	shm->conf.polling = false;
+	shm->conf.spin = 0;
 	shm->exec = NULL;
 
-	ret = json_unpack_ex(cfg, &err, 0, "{ s: s, s: s, s?: i, s?: b, s?: o }",
+	ret = json_unpack_ex(cfg, &err, 0, "{ s: s, s: s, s?: i, s?: b, s?: i, s?: o }",
 		"out_name", &shm->out_name,
 		"in_name", &shm->in_name,
 		"queuelen", &shm->conf.queuelen,
 		"polling", &shm->conf.polling,
+		"spin", &shm->conf.spin,
 		"exec", &json_exec
 	);
 	if (ret)
@@ -131,6 +133,13 @@ int shmem_read(struct node *n, struct sample *smps[], unsigned cnt)
 	return recv;
 }
 
+int shmem_available(struct node *n)
+{
+	struct shmem *shm = (struct shmem *) n->_vd;
+
+	return queue_signalled_available(&shm->intf.read.shared->queue);
+}
+
 int shmem_write(struct node *n, struct sample *smps[], unsigned cnt)
 {
 	struct shmem *shm = (struct shmem *) n->_vd;
@@ -161,8 +170,8 @@ char * shmem_print(struct node *n)
 	struct shmem *shm = (struct shmem *) n->_vd;
 	char *buf = NULL;
 
-	strcatf(&buf, "out_name=%s, in_name=%s, queuelen=%d, polling=%s",
-		shm->out_name, shm->in_name, shm->conf.queuelen, shm->conf.polling ? "yes" : "no");
+	strcatf(&buf, "out_name=%s, in_name=%s, queuelen=%d, polling=%s, spin=%d",
+		shm->out_name, shm->in_name, shm->conf.queuelen, shm->conf.polling ? "yes" : "no", shm->conf.spin);
 
 	if (shm->exec) {
 		strcatf(&buf, ", exec='");
@@ -188,7 +197,8 @@ static struct plugin p = {
 		.start	= shmem_open,
 		.stop	= shmem_close,
 		.read	= shmem_read,
-		.write	= shmem_write
+		.write	= shmem_write,
+		.available = shmem_available
 	}
 };
 
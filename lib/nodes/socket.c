@@ -27,7 +27,21 @@
 #include <errno.h>
 
 #if defined(__linux__)
+  #include <poll.h>
+  #include <stdatomic.h>
+  #include <net/if.h>
+  #include <sys/ioctl.h>
+  #include <pthread.h>
+  #include <sched.h>
+  #include <sys/mman.h>
+  #include <sys/sysinfo.h>
   #include <netinet/ether.h>
+  #include <netinet/udp.h>
+  #include <netinet/ip6.h>
+  #include <linux/filter.h>
+  #include <linux/errqueue.h>
+  #include <linux/net_tstamp.h>
+  #include <linux/sockios.h>
 #endif
 
 #include "nodes/socket.h"
@@ -43,6 +57,7 @@
 #include "io_format.h"
 #include "sample.h"
 #include "queue.h"
+#include "timing.h"
 #include "plugin.h"
 #include "compat.h"
 
@@ -94,6 +109,10 @@ int socket_init(struct super_node *sn)
 		list_push(&interfaces, i);
 
 found:		list_push(&i->sockets, s);
+
+		/* Place the buffers of the node next to its NIC unless configured otherwise */
+		if (n->numa_node < 0)
+			n->numa_node = if_get_numa_node(i);
 	}
 
 	for (size_t j = 0; j < list_length(&interfaces); j++) {
@@ -126,36 +145,1221 @@ char * socket_print(struct node *n)
 	struct socket *s = (struct socket *) n->_vd;
 	char *layer = NULL, *buf;
 
-	switch (s->layer) {
-		case SOCKET_LAYER_UDP:	layer = "udp";	break;
-		case SOCKET_LAYER_IP:	layer = "ip";	break;
-		case SOCKET_LAYER_ETH:	layer = "eth";	break;
-	}
+	switch (s->layer) {
+		case SOCKET_LAYER_UDP:	layer = "udp";	break;
+		case SOCKET_LAYER_IP:	layer = "ip";	break;
+		case SOCKET_LAYER_ETH:	layer = "eth";	break;
+	}
+
+	char *local = socket_print_addr((struct sockaddr *) &s->local);
+	char *remote = socket_print_addr((struct sockaddr *) &s->remote);
+
+	buf = strf("layer=%s, format=%s, local=%s, remote=%s", layer, plugin_name(s->format), local, remote);
+
+	if (s->multicast.enabled) {
+		char group[INET_ADDRSTRLEN];
+		char interface[INET_ADDRSTRLEN];
+
+		inet_ntop(AF_INET, &s->multicast.mreq.imr_multiaddr, group, sizeof(group));
+		inet_ntop(AF_INET, &s->multicast.mreq.imr_interface, interface, sizeof(interface));
+
+		strcatf(&buf, ", multicast.enabled=%s", s->multicast.enabled ? "yes" : "no");
+		strcatf(&buf, ", multicast.loop=%s",    s->multicast.loop    ? "yes" : "no");
+		strcatf(&buf, ", multicast.group=%s", group);
+		strcatf(&buf, ", multicast.interface=%s", s->multicast.mreq.imr_interface.s_addr == INADDR_ANY ? "any" : interface);
+		strcatf(&buf, ", multicast.ttl=%u", s->multicast.ttl);
+	}
+
+	if (s->io_uring)
+		strcatf(&buf, ", io_uring=yes");
+
+	if (s->nworkers > 1)
+		strcatf(&buf, ", workers=%d", s->nworkers);
+
+	if (s->gso)
+		strcatf(&buf, ", gso=yes");
+
+	if (s->zerocopy)
+		strcatf(&buf, ", zerocopy=yes");
+
+#ifdef __linux__
+	if (s->txtime.enabled)
+		strcatf(&buf, ", txtime.offset=%.6f, txtime.deadline=%s", s->txtime.offset * 1e-9, s->txtime.deadline ? "yes" : "no");
+#endif /* __linux__ */
+
+	switch (s->timestamping) {
+		case SOCKET_TIMESTAMPING_SOFTWARE: strcatf(&buf, ", timestamping=software"); break;
+		case SOCKET_TIMESTAMPING_HARDWARE: strcatf(&buf, ", timestamping=hardware"); break;
+		default: { }
+	}
+
+#ifdef __linux__
+	if (s->ring.enabled)
+		strcatf(&buf, ", ring.blocks=%u, ring.block_size=%u, ring.frame_size=%u", s->ring.req.tp_block_nr, s->ring.req.tp_block_size, s->ring.req.tp_frame_size);
+#endif /* __linux__ */
+
+	free(local);
+	free(remote);
+
+	return buf;
+}
+
+/** Allocate buffers for up to \p len datagrams of \p size bytes each.
+ *
+ * If \p size is zero, no payload buffers are allocated and the caller has to set socket_batch::iov.
+ */
+static int socket_batch_init(struct socket_batch *b, int len, size_t size)
+{
+	b->len = len;
+	b->size = size;
+	b->buf = size ? alloc(len * size) : NULL;
+	b->ctrl = alloc(len * SOCKET_MAX_CTRL_LEN);
+	b->msgs = alloc(len * sizeof(struct mmsghdr));
+	b->iov = alloc(len * sizeof(struct iovec));
+	b->addrs = alloc(len * sizeof(union sockaddr_union));
+	b->first = alloc((len + 1) * sizeof(unsigned));
+
+	for (int i = 0; i < len; i++) {
+		struct msghdr *mhdr = &b->msgs[i].msg_hdr;
+
+		b->iov[i].iov_base = b->buf ? b->buf + i * size : NULL;
+		b->iov[i].iov_len = size;
+
+		mhdr->msg_iov = &b->iov[i];
+		mhdr->msg_iovlen = 1;
+		mhdr->msg_name = &b->addrs[i];
+		mhdr->msg_namelen = sizeof(b->addrs[i]);
+		mhdr->msg_control = b->ctrl + i * SOCKET_MAX_CTRL_LEN;
+		mhdr->msg_controllen = SOCKET_MAX_CTRL_LEN;
+	}
+
+	return 0;
+}
+
+#ifdef __linux__
+/** Append a control message with \p len bytes of data to datagram \p i of a batch which is sent.
+ *
+ * @return A pointer to the data of the control message.
+ */
+static void * socket_batch_cmsg(struct socket_batch *b, int i, int level, int type, size_t len)
+{
+	struct msghdr *mhdr = &b->msgs[i].msg_hdr;
+	struct cmsghdr *cmsg;
+
+	if (!mhdr->msg_control) {
+		mhdr->msg_control = b->ctrl + i * SOCKET_MAX_CTRL_LEN;
+		mhdr->msg_controllen = 0;
+	}
+
+	assert(mhdr->msg_controllen + CMSG_SPACE(len) <= SOCKET_MAX_CTRL_LEN);
+
+	cmsg = (struct cmsghdr *) ((char *) mhdr->msg_control + mhdr->msg_controllen);
+	cmsg->cmsg_level = level;
+	cmsg->cmsg_type = type;
+	cmsg->cmsg_len = CMSG_LEN(len);
+
+	mhdr->msg_controllen += CMSG_SPACE(len);
+
+	return CMSG_DATA(cmsg);
+}
+#endif /* __linux__ */
+
+static int socket_batch_destroy(struct socket_batch *b)
+{
+	free(b->buf);
+	free(b->ctrl);
+	free(b->msgs);
+	free(b->iov);
+	free(b->addrs);
+	free(b->first);
+
+	b->len = 0;
+
+	return 0;
+}
+
+#ifdef __linux__
+static int socket_timestamping_init(struct node *n, int sd)
+{
+	int ret, flags;
+	struct socket *s = (struct socket *) n->_vd;
+
+	flags = SOF_TIMESTAMPING_RX_SOFTWARE | SOF_TIMESTAMPING_SOFTWARE;
+
+	/* Transmit timestamps are not supported for the TX ring and io_uring */
+	if (!s->ring.enabled && !s->io_uring)
+		flags |= SOF_TIMESTAMPING_TX_SOFTWARE | SOF_TIMESTAMPING_OPT_ID | SOF_TIMESTAMPING_OPT_TSONLY;
+
+	/* Transmit timestamps are only collected right after sendmmsg() returned.
+	 * Those of the NIC usually arrive later, so only the receive side uses hardware timestamps. */
+	if (s->timestamping == SOCKET_TIMESTAMPING_HARDWARE) {
+		flags |= SOF_TIMESTAMPING_RX_HARDWARE | SOF_TIMESTAMPING_RAW_HARDWARE;
+
+		/* We can only enable timestamping of the NIC if we know the interface.
+		 * For the IP and UDP layers it must be enabled externally (e.g. with hwstamp_ctl). */
+		if (s->layer == SOCKET_LAYER_ETH) {
+			struct ifreq ifr = { 0 };
+			struct hwtstamp_config hwcfg = {
+				.tx_type = HWTSTAMP_TX_OFF,
+				.rx_filter = HWTSTAMP_FILTER_ALL
+			};
+
+			if_indextoname(s->local.sll.sll_ifindex, ifr.ifr_name);
+			ifr.ifr_data = (void *) &hwcfg;
+
+			ret = ioctl(sd, SIOCSHWTSTAMP, &ifr);
+			if (ret)
+				warn("Failed to enable hardware timestamping for interface %s of node %s: %s", ifr.ifr_name, node_name(n), strerror(errno));
+		}
+	}
+
+	ret = setsockopt(sd, SOL_SOCKET, SO_TIMESTAMPING, &flags, sizeof(flags));
+	if (ret)
+		return ret;
+
+	if (s->ring.enabled) {
+		int ringflags = s->timestamping == SOCKET_TIMESTAMPING_HARDWARE
+			? SOF_TIMESTAMPING_RAW_HARDWARE
+			: SOF_TIMESTAMPING_SOFTWARE;
+
+		ret = setsockopt(sd, SOL_PACKET, PACKET_TIMESTAMP, &ringflags, sizeof(ringflags));
+		if (ret)
+			return ret;
+	}
+
+	s->tx_key = 0;
+
+	debug(LOG_SOCKET | 4, "Enabled %s timestamping for node %s", s->timestamping == SOCKET_TIMESTAMPING_HARDWARE ? "hardware" : "software", node_name(n));
+
+	return 0;
+}
+
+/** Get the timestamp from a SCM_TIMESTAMPING control message. Hardware timestamps take precedence. */
+static int socket_timestamping_get(struct socket *s, struct cmsghdr *cmsg, struct timespec *ts)
+{
+	struct scm_timestamping *tss = (struct scm_timestamping *) CMSG_DATA(cmsg);
+
+	if (s->timestamping == SOCKET_TIMESTAMPING_HARDWARE && (tss->ts[2].tv_sec || tss->ts[2].tv_nsec))
+		*ts = tss->ts[2];
+	else if (tss->ts[0].tv_sec || tss->ts[0].tv_nsec)
+		*ts = tss->ts[0];
+	else
+		return -1;
+
+	return 0;
+}
+
+/** Get the receive timestamp from the control messages of a received datagram. */
+static int socket_timestamping_rx(struct socket *s, struct msghdr *mhdr, struct timespec *ts)
+{
+	for (struct cmsghdr *cmsg = CMSG_FIRSTHDR(mhdr); cmsg; cmsg = CMSG_NXTHDR(mhdr, cmsg)) {
+		if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_TIMESTAMPING)
+			return socket_timestamping_get(s, cmsg, ts);
+	}
+
+	return -1;
+}
+
+static int socket_txtime_init(struct node *n)
+{
+	int ret;
+	struct socket *s = (struct socket *) n->_vd;
+
+	struct sock_txtime cfg = {
+		.clockid = s->txtime.clock,
+		.flags = SOF_TXTIME_REPORT_ERRORS
+	};
+
+	if (s->txtime.deadline)
+		cfg.flags |= SOF_TXTIME_DEADLINE_MODE;
+
+	ret = setsockopt(s->sd, SOL_SOCKET, SO_TXTIME, &cfg, sizeof(cfg));
+	if (ret)
+		return ret;
+
+	debug(LOG_SOCKET | 4, "Enabled SO_TXTIME for node %s", node_name(n));
+
+	return 0;
+}
+
+/** Add a SCM_TXTIME control message to each of the first \p nmsgs datagrams of a batch.
+ *
+ * The launch time of a datagram is the origin timestamp of its first sample plus socket_txtime::offset.
+ * It is converted from CLOCK_REALTIME to socket_txtime::clock.
+ */
+static void socket_txtime_set(struct node *n, struct socket_batch *b, struct sample *smps[], int nmsgs)
+{
+	struct socket *s = (struct socket *) n->_vd;
+	struct timespec now, clk;
+	int64_t delta;
+
+	now = time_now();
+	clock_gettime(s->txtime.clock, &clk);
+
+	delta = (clk.tv_sec - now.tv_sec) * 1000000000LL + (clk.tv_nsec - now.tv_nsec) + s->txtime.offset;
+
+	for (int i = 0; i < nmsgs; i++) {
+		struct sample *smp = smps[b->first[i]];
+		struct timespec ts = smp->flags & SAMPLE_HAS_ORIGIN ? smp->ts.origin : now;
+
+		*(uint64_t *) socket_batch_cmsg(b, i, SOL_SOCKET, SCM_TXTIME, sizeof(uint64_t)) = ts.tv_sec * 1000000000LL + ts.tv_nsec + delta;
+	}
+}
+
+static int socket_zerocopy_init(struct node *n)
+{
+	int ret, one = 1;
+	struct socket *s = (struct socket *) n->_vd;
+	struct socket_zerocopy *zc = &s->zc;
+
+	ret = setsockopt(s->sd, SOL_SOCKET, SO_ZEROCOPY, &one, sizeof(one));
+	if (ret)
+		return ret;
+
+	zc->depth = SOCKET_ZEROCOPY_DEPTH * n->vectorize;
+	zc->pending = alloc(zc->depth * sizeof(char *));
+	zc->next = 0;
+
+	ret = pthread_mutex_init(&zc->lock, NULL);
+	if (ret)
+		return ret;
+
+	/* Pages which are pinned by the kernel must not be shared with other data.
+	 * Hence each block starts at a page boundary and spans a multiple of the page size. */
+	ret = pool_init_aligned(&zc->pool, zc->depth, ALIGN(SOCKET_GSO_MAX_LEN, getpagesize()), getpagesize(), &memtype_hugepage);
+	if (ret)
+		return ret;
+
+	debug(LOG_SOCKET | 4, "Allocated %u zerocopy buffers of %zu bytes for node %s", zc->depth, zc->pool.blocksz, node_name(n));
+
+	return 0;
+}
+
+static int socket_zerocopy_destroy(struct node *n)
+{
+	int ret;
+	struct socket *s = (struct socket *) n->_vd;
+	struct socket_zerocopy *zc = &s->zc;
+
+	if (!s->zerocopy)
+		return 0;
+
+	/* The socket has already been closed. The kernel releases pinned pages on its own. */
+	ret = pool_destroy(&zc->pool);
+	if (ret)
+		return ret;
+
+	free(zc->pending);
+
+	return pthread_mutex_destroy(&zc->lock);
+}
+
+/** Return the buffers of the sends with ids sock_extended_err::ee_info to sock_extended_err::ee_data (inclusive) to the pool. */
+static void socket_zerocopy_complete(struct node *n, struct sock_extended_err *serr)
+{
+	struct socket *s = (struct socket *) n->_vd;
+	struct socket_zerocopy *zc = &s->zc;
+
+	pthread_mutex_lock(&zc->lock);
+
+	for (uint32_t id = serr->ee_info; id != serr->ee_data + 1; id++) {
+		char **slot = &zc->pending[id % zc->depth];
+
+		if (*slot) {
+			pool_put(&zc->pool, *slot);
+			*slot = NULL;
+		}
+	}
+
+	pthread_mutex_unlock(&zc->lock);
+
+	if (serr->ee_code & SO_EE_CODE_ZEROCOPY_COPIED)
+		debug(LOG_SOCKET | 10, "Kernel copied the data of zerocopy sends %u-%u of node %s", serr->ee_info, serr->ee_data, node_name(n));
+}
+
+/** Process the notifications on the error queue of the socket.
+ *
+ * Transmit timestamps are assigned to the samples of the last \p nmsgs datagrams.
+ * Timestamps which arrive after the next call of socket_write() or which are
+ * drained by socket_poll_error() can not be matched anymore and are discarded.
+ * MSG_ZEROCOPY completions release the send buffers.
+ * Datagrams which have been dropped by the ETF qdisc are reported.
+ */
+static void socket_errqueue(struct node *n, struct sample *smps[], int nmsgs)
+{
+	int ret;
+	struct socket *s = (struct socket *) n->_vd;
+	struct socket_batch *b = &s->tx;
+
+	char ctrl[SOCKET_MAX_CTRL_LEN];
+	struct msghdr mhdr = {
+		.msg_control = ctrl
+	};
+
+	for (;;) {
+		struct sock_extended_err *serr = NULL;
+		struct timespec ts;
+		uint32_t idx;
+		int valid = 0;
+
+		mhdr.msg_controllen = sizeof(ctrl);
+
+		ret = recvmsg(s->sd, &mhdr, MSG_ERRQUEUE | MSG_DONTWAIT);
+		if (ret < 0)
+			break;
+
+		for (struct cmsghdr *cmsg = CMSG_FIRSTHDR(&mhdr); cmsg; cmsg = CMSG_NXTHDR(&mhdr, cmsg)) {
+			if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_TIMESTAMPING)
+				valid = socket_timestamping_get(s, cmsg, &ts) == 0;
+			else if ((cmsg->cmsg_level == SOL_IP     && cmsg->cmsg_type == IP_RECVERR) ||
+				 (cmsg->cmsg_level == SOL_IPV6   && cmsg->cmsg_type == IPV6_RECVERR) ||
+				 (cmsg->cmsg_level == SOL_PACKET && cmsg->cmsg_type == PACKET_TX_TIMESTAMP))
+				serr = (struct sock_extended_err *) CMSG_DATA(cmsg);
+		}
+
+		if (serr && serr->ee_origin == SO_EE_ORIGIN_ZEROCOPY) {
+			socket_zerocopy_complete(n, serr);
+			continue;
+		}
+
+		if (serr && serr->ee_origin == SO_EE_ORIGIN_TXTIME) {
+			warn("Datagram of node %s has been dropped: %s", node_name(n),
+				serr->ee_code == SO_EE_CODE_TXTIME_MISSED ? "launch time missed" : "invalid launch time");
+			continue;
+		}
+
+		if (!valid || !serr || serr->ee_origin != SO_EE_ORIGIN_TIMESTAMPING)
+			continue;
+
+		/* SOF_TIMESTAMPING_OPT_ID numbers all datagrams which have been sent on the socket */
+		idx = serr->ee_data - (s->tx_key - nmsgs);
+		if (idx >= nmsgs) {
+			debug(LOG_SOCKET | 10, "Discarded late transmit timestamp of node %s", node_name(n));
+			continue;
+		}
+
+		for (unsigned j = b->first[idx]; j < b->first[idx + 1]; j++)
+			smps[j]->ts.sent = ts;
+	}
+}
+
+/** Wait for the completion of zerocopy sends.
+ *
+ * The reading thread might process the completions concurrently in socket_poll_error().
+ * Hence the wait is bounded and the caller has to check again.
+ */
+static void socket_zerocopy_wait(struct node *n)
+{
+	int ret;
+	struct socket *s = (struct socket *) n->_vd;
+
+	/* Notifications on the error queue are signalled by POLLERR */
+	struct pollfd pfd = {
+		.fd = s->sd,
+		.events = 0
+	};
+
+	ret = poll(&pfd, 1, 1);
+	if (ret < 0 && errno != EINTR)
+		serror("Failed to wait for zerocopy completions of node %s", node_name(n));
+
+	socket_errqueue(n, NULL, 0);
+}
+
+/** Take a free buffer from the pool. Waits for completions if all buffers are in flight. */
+static char * socket_zerocopy_get(struct node *n)
+{
+	char *buf;
+	struct socket *s = (struct socket *) n->_vd;
+
+	while (!(buf = pool_get(&s->zc.pool)))
+		socket_zerocopy_wait(n);
+
+	return buf;
+}
+
+/** Keep the buffer of a successful send until the kernel reports its completion. */
+static void socket_zerocopy_track(struct node *n, char *buf)
+{
+	int busy;
+	struct socket *s = (struct socket *) n->_vd;
+	struct socket_zerocopy *zc = &s->zc;
+
+	/* Completions might be reported out of order */
+	for (;;) {
+		pthread_mutex_lock(&zc->lock);
+
+		busy = zc->pending[zc->next % zc->depth] != NULL;
+		if (!busy)
+			zc->pending[zc->next++ % zc->depth] = buf;
+
+		pthread_mutex_unlock(&zc->lock);
+
+		if (!busy)
+			break;
+
+		socket_zerocopy_wait(n);
+	}
+}
+#endif /* __linux__ */
+
+/** Parse the samples of a single received datagram.
+ *
+ * @param src The source address of the datagram.
+ * @param ts The receive timestamp of the datagram or NULL.
+ * @return The number of samples which have been parsed or -1 if the datagram has been discarded.
+ */
+static int socket_read_packet(struct node *n, char *bufptr, ssize_t bytes, union sockaddr_union *src, struct timespec *ts, struct sample *smps[], unsigned cnt)
+{
+	int ret;
+	struct socket *s = (struct socket *) n->_vd;
+	size_t rbytes;
+
+	/* Strip IP header from packet */
+	if (s->layer == SOCKET_LAYER_IP) {
+		struct ip *iphdr = (struct ip *) bufptr;
+
+		bytes  -= iphdr->ip_hl * 4;
+		bufptr += iphdr->ip_hl * 4;
+	}
+
+	/* SOCK_RAW IP sockets to not provide the IP protocol number via recvmsg()
+	 * So we simply set it ourself. */
+	if (s->layer == SOCKET_LAYER_IP) {
+		switch (src->sa.sa_family) {
+			case AF_INET: src->sin.sin_port = s->remote.sin.sin_port; break;
+			case AF_INET6: src->sin6.sin6_port = s->remote.sin6.sin6_port; break;
+		}
+	}
+
+	if (s->verify_source && socket_compare_addr(&src->sa, &s->remote.sa) != 0) {
+		char *buf = socket_print_addr((struct sockaddr *) src);
+		warn("Received packet from unauthorized source: %s", buf);
+		free(buf);
+
+		return -1;
+	}
+
+	ret = io_format_sscan(s->format, bufptr, bytes, &rbytes, smps, cnt, 0);
+	if (ret < 0) {
+		warn("Failed to parse packet from node %s", node_name(n));
+		return -1;
+	}
+
+	if (bytes != rbytes)
+		warn("Received invalid packet from node: %s bytes=%zu, rbytes=%zu", node_name(n), bytes, rbytes);
+
+	if (ts) {
+		for (int j = 0; j < ret; j++) {
+			smps[j]->ts.received = *ts;
+			smps[j]->flags |= SAMPLE_HAS_RECEIVED;
+		}
+	}
+
+	return ret;
+}
+
+#ifdef __linux__
+/** The offset of the payload within a TX frame (see Documentation/networking/packet_mmap.txt). */
+#define SOCKET_RING_TX_OFFSET TPACKET_ALIGN(sizeof(struct tpacket3_hdr))
+
+static int socket_ring_init(struct socket *s)
+{
+	int ret, version = TPACKET_V3;
+	struct socket_ring *r = &s->ring;
+	struct tpacket_req3 txreq;
+
+	ret = setsockopt(s->sd, SOL_PACKET, PACKET_VERSION, &version, sizeof(version));
+	if (ret)
+		return ret;
+
+	r->req.tp_frame_nr = r->req.tp_block_size / r->req.tp_frame_size * r->req.tp_block_nr;
+	r->req.tp_sizeof_priv = 0;
+	r->req.tp_feature_req_word = 0;
+
+	ret = setsockopt(s->sd, SOL_PACKET, PACKET_RX_RING, &r->req, sizeof(r->req));
+	if (ret)
+		return ret;
+
+	/* Blocks of the TX ring are never retired by a timer */
+	txreq = r->req;
+	txreq.tp_retire_blk_tov = 0;
+
+	ret = setsockopt(s->sd, SOL_PACKET, PACKET_TX_RING, &txreq, sizeof(txreq));
+	if (ret)
+		return ret;
+
+	r->maplen = 2 * (size_t) r->req.tp_block_size * r->req.tp_block_nr;
+	r->map = mmap(NULL, r->maplen, PROT_READ | PROT_WRITE, MAP_SHARED, s->sd, 0);
+	if (r->map == MAP_FAILED) {
+		r->map = NULL;
+		return -1;
+	}
+
+	r->rx_block = 0;
+	r->rx_pkts = 0;
+	r->rx_pkt = NULL;
+
+	r->tx_frame = 0;
+	r->tx_nr = txreq.tp_frame_nr;
+
+	return 0;
+}
+
+static int socket_ring_destroy(struct socket *s)
+{
+	struct socket_ring *r = &s->ring;
+
+	if (!r->map)
+		return 0;
+
+	return munmap(r->map, r->maplen);
+}
+
+static int socket_ring_read(struct node *n, struct sample *smps[], unsigned cnt)
+{
+	int ret, nread = 0;
+	struct socket *s = (struct socket *) n->_vd;
+	struct socket_ring *r = &s->ring;
+
+	while (nread < cnt) {
+		struct tpacket_block_desc *bd = (struct tpacket_block_desc *) (r->map + r->rx_block * r->req.tp_block_size);
+
+		if (!r->rx_pkt) {
+			if (!(bd->hdr.bh1.block_status & TP_STATUS_USER)) {
+				if (nread > 0)
+					break;
+
+				/* Wait until the kernel retires the next block */
+				struct pollfd pfd = {
+					.fd = s->sd,
+					.events = POLLIN | POLLERR
+				};
+
+				ret = poll(&pfd, 1, -1);
+				if (ret < 0 && errno != EINTR)
+					serror("Failed to poll for frames of node %s", node_name(n));
+
+				continue;
+			}
+
+			atomic_thread_fence(memory_order_acquire);
+
+			r->rx_pkts = bd->hdr.bh1.num_pkts;
+			r->rx_pkt = (struct tpacket3_hdr *) ((char *) bd + bd->hdr.bh1.offset_to_first_pkt);
+		}
+
+		while (r->rx_pkts > 0 && nread < cnt) {
+			struct tpacket3_hdr *pkt = r->rx_pkt;
+			struct sockaddr_ll *src = (struct sockaddr_ll *) ((char *) pkt + TPACKET_ALIGN(sizeof(struct tpacket3_hdr)));
+
+			struct timespec ts = {
+				.tv_sec = pkt->tp_sec,
+				.tv_nsec = pkt->tp_nsec
+			};
+
+			r->rx_pkt = (struct tpacket3_hdr *) ((char *) pkt + pkt->tp_next_offset);
+			r->rx_pkts--;
+
+			ret = socket_read_packet(n, (char *) pkt + pkt->tp_mac, pkt->tp_snaplen, (union sockaddr_union *) src,
+				s->timestamping && (pkt->tp_status & (TP_STATUS_TS_SOFTWARE | TP_STATUS_TS_RAW_HARDWARE)) ? &ts : NULL,
+				&smps[nread], cnt - nread);
+			if (ret < 0)
+				continue;
+
+			nread += ret;
+		}
+
+		/* Hand the block back to the kernel once all of its frames have been parsed */
+		if (r->rx_pkts == 0) {
+			atomic_thread_fence(memory_order_release);
+
+			bd->hdr.bh1.block_status = TP_STATUS_KERNEL;
+
+			r->rx_pkt = NULL;
+			r->rx_block = (r->rx_block + 1) % r->req.tp_block_nr;
+		}
+	}
+
+	return nread;
+}
+
+/** Ask the kernel to transmit all frames of the TX ring which are marked with TP_STATUS_SEND_REQUEST. */
+static int socket_ring_send(struct node *n)
+{
+	int ret;
+	struct socket *s = (struct socket *) n->_vd;
+
+	ret = sendto(s->sd, NULL, 0, 0, (struct sockaddr *) &s->remote, sizeof(s->remote.sll));
+	if (ret < 0) {
+		if (errno == EPERM) {
+			warn("Failed send to node %s: %s", node_name(n), strerror(errno));
+			return -1;
+		}
+		else
+			serror("Failed send to node %s", node_name(n));
+	}
+
+	return 0;
+}
+
+static int socket_ring_write(struct node *n, struct sample *smps[], unsigned cnt)
+{
+	int ret, nframes = 0;
+	struct socket *s = (struct socket *) n->_vd;
+	struct socket_ring *r = &s->ring;
+
+	char *tx = r->map + (size_t) r->req.tp_block_size * r->req.tp_block_nr;
+	size_t wbytes, maxlen = MIN(r->req.tp_frame_size - SOCKET_RING_TX_OFFSET, SOCKET_MAX_PACKET_LEN);
+	unsigned nwritten = 0;
+
+	while (nwritten < cnt) {
+		struct tpacket3_hdr *hdr = (struct tpacket3_hdr *) (tx + r->tx_frame * r->req.tp_frame_size);
+
+		if (hdr->tp_status & TP_STATUS_WRONG_FORMAT) {
+			warn("Kernel rejected frame of node %s", node_name(n));
+			hdr->tp_status = TP_STATUS_AVAILABLE;
+		}
+
+		/* The ring is full: flush it before we continue */
+		if (hdr->tp_status != TP_STATUS_AVAILABLE) {
+			if (nframes == 0) {
+				warn("TX ring of node %s is full", node_name(n));
+				break;
+			}
+
+			ret = socket_ring_send(n);
+			if (ret)
+				return nwritten;
+
+			nframes = 0;
+			continue;
+		}
+
+		ret = io_format_sprint(s->format, (char *) hdr + SOCKET_RING_TX_OFFSET, maxlen, &wbytes, &smps[nwritten], cnt - nwritten, SAMPLE_HAS_ALL);
+		if (ret < 0)
+			return -1;
+
+		if (ret == 0 || wbytes <= 0)
+			break;
+
+		hdr->tp_len = wbytes;
+		hdr->tp_next_offset = 0;
+
+		atomic_thread_fence(memory_order_release);
+
+		hdr->tp_status = TP_STATUS_SEND_REQUEST;
+
+		r->tx_frame = (r->tx_frame + 1) % r->tx_nr;
+
+		nwritten += ret;
+		nframes++;
+	}
+
+	if (nframes > 0)
+		socket_ring_send(n);
+
+	return nwritten;
+}
+#endif /* __linux__ */
+
+#ifdef WITH_LIBURING
+/** The number of buffers which are provided for multishot receives. Must be a power of two. */
+#define SOCKET_URING_BUFS	256
+
+/** The size of a receive buffer: header, source address, control messages and payload. */
+#define SOCKET_URING_BUF_LEN	(sizeof(struct io_uring_recvmsg_out) + sizeof(union sockaddr_union) + SOCKET_MAX_CTRL_LEN + SOCKET_MAX_PACKET_LEN)
+
+/** The number of entries of the submission queues. */
+#define SOCKET_URING_DEPTH	64
+
+/** (Re-)arm the multishot receive. The kernel terminates it e.g. when it runs out of buffers. */
+static int socket_uring_arm(struct node *n)
+{
+	struct socket *s = (struct socket *) n->_vd;
+	struct io_uring_sqe *sqe;
+
+	sqe = io_uring_get_sqe(&s->rx_uring.ring);
+	if (!sqe)
+		return -1;
+
+	io_uring_prep_recvmsg_multishot(sqe, s->sd, &s->rx_msg, 0);
+
+	sqe->flags |= IOSQE_BUFFER_SELECT;
+	sqe->buf_group = 0;
+
+	return uring_submit(&s->rx_uring) < 0 ? -1 : 0;
+}
+
+static int socket_uring_init(struct node *n)
+{
+	int ret, mask = io_uring_buf_ring_mask(SOCKET_URING_BUFS);
+	struct socket *s = (struct socket *) n->_vd;
+
+	ret = uring_init(&s->rx_uring, SOCKET_URING_DEPTH);
+	if (ret)
+		return ret;
+
+	ret = uring_init(&s->tx_uring, SOCKET_URING_DEPTH);
+	if (ret)
+		return ret;
+
+	s->rx_bufs = io_uring_setup_buf_ring(&s->rx_uring.ring, SOCKET_URING_BUFS, 0, 0, &ret);
+	if (!s->rx_bufs) {
+		errno = -ret;
+		return -1;
+	}
+
+	s->rx_mem = alloc(SOCKET_URING_BUFS * SOCKET_URING_BUF_LEN);
+
+	for (int i = 0; i < SOCKET_URING_BUFS; i++)
+		io_uring_buf_ring_add(s->rx_bufs, s->rx_mem + i * SOCKET_URING_BUF_LEN, SOCKET_URING_BUF_LEN, i, mask, i);
+
+	io_uring_buf_ring_advance(s->rx_bufs, SOCKET_URING_BUFS);
+
+	memset(&s->rx_msg, 0, sizeof(s->rx_msg));
+	s->rx_msg.msg_namelen = sizeof(union sockaddr_union);
+	s->rx_msg.msg_controllen = s->timestamping ? SOCKET_MAX_CTRL_LEN : 0;
+
+	return socket_uring_arm(n);
+}
+
+static int socket_uring_destroy(struct node *n)
+{
+	struct socket *s = (struct socket *) n->_vd;
+
+	if (!s->rx_bufs)
+		return 0;
+
+	io_uring_free_buf_ring(&s->rx_uring.ring, s->rx_bufs, SOCKET_URING_BUFS, 0);
+
+	uring_destroy(&s->tx_uring);
+	uring_destroy(&s->rx_uring);
+
+	free(s->rx_mem);
+
+	s->rx_bufs = NULL;
+	s->rx_mem = NULL;
+
+	return 0;
+}
+
+static int socket_uring_read(struct node *n, struct sample *smps[], unsigned cnt)
+{
+	int ret, nread = 0, rearm = 0, mask = io_uring_buf_ring_mask(SOCKET_URING_BUFS);
+	unsigned ncqes, seen;
+	struct socket *s = (struct socket *) n->_vd;
+	struct io_uring *ring = &s->rx_uring.ring;
+	struct io_uring_cqe *cqes[SOCKET_URING_BUFS];
+
+	/* Wait for the first datagram and reap all others which are already available */
+	ret = io_uring_wait_cqe(ring, &cqes[0]);
+	if (ret < 0) {
+		if (ret == -EINTR)
+			return 0;
+
+		errno = -ret;
+		serror("Failed recv from node %s", node_name(n));
+	}
+
+	/* Every datagram contains at least one sample */
+	ncqes = io_uring_peek_batch_cqe(ring, cqes, MIN(cnt, SOCKET_URING_BUFS));
+
+	for (seen = 0; seen < ncqes && nread < cnt; seen++) {
+		struct io_uring_cqe *cqe = cqes[seen];
+		struct io_uring_recvmsg_out *out;
+		struct timespec ts, *tsp = NULL;
+		char *buf;
+		int bid;
+
+		if (!(cqe->flags & IORING_CQE_F_MORE))
+			rearm = 1;
+
+		if (cqe->res < 0) {
+			if (cqe->res != -ENOBUFS)
+				warn("Failed recv from node %s: %s", node_name(n), strerror(-cqe->res));
+
+			continue;
+		}
+
+		if (!(cqe->flags & IORING_CQE_F_BUFFER))
+			continue;
+
+		bid = cqe->flags >> IORING_CQE_BUFFER_SHIFT;
+		buf = s->rx_mem + bid * SOCKET_URING_BUF_LEN;
+
+		out = io_uring_recvmsg_validate(buf, cqe->res, &s->rx_msg);
+		if (out) {
+			if (out->flags & MSG_TRUNC)
+				warn("Received truncated packet from node %s", node_name(n));
+
+			for (struct cmsghdr *cmsg = io_uring_recvmsg_cmsg_firsthdr(out, &s->rx_msg); cmsg; cmsg = io_uring_recvmsg_cmsg_nexthdr(out, &s->rx_msg, cmsg)) {
+				if (s->timestamping && cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_TIMESTAMPING && !socket_timestamping_get(s, cmsg, &ts))
+					tsp = &ts;
+			}
+
+			ret = socket_read_packet(n, io_uring_recvmsg_payload(out, &s->rx_msg), io_uring_recvmsg_payload_length(out, cqe->res, &s->rx_msg),
+				(union sockaddr_union *) io_uring_recvmsg_name(out), tsp, &smps[nread], cnt - nread);
+			if (ret > 0)
+				nread += ret;
+		}
+
+		/* Hand the buffer back to the kernel */
+		io_uring_buf_ring_add(s->rx_bufs, buf, SOCKET_URING_BUF_LEN, bid, mask, 0);
+		io_uring_buf_ring_advance(s->rx_bufs, 1);
+	}
+
+	io_uring_cq_advance(ring, seen);
+
+	if (rearm) {
+		ret = socket_uring_arm(n);
+		if (ret)
+			serror("Failed to re-arm receive of node %s", node_name(n));
+	}
+
+	return nread;
+}
+#endif /* WITH_LIBURING */
+
+#ifdef __linux__
+/** Get the segment size of a datagram which has been coalesced by UDP_GRO or 0 if it has not been coalesced. */
+static int socket_gro_size(struct msghdr *mhdr)
+{
+	for (struct cmsghdr *cmsg = CMSG_FIRSTHDR(mhdr); cmsg; cmsg = CMSG_NXTHDR(mhdr, cmsg)) {
+		if (cmsg->cmsg_level == SOL_UDP && cmsg->cmsg_type == UDP_GRO)
+			return *(int *) CMSG_DATA(cmsg);
+	}
+
+	return 0;
+}
+
+/** Get the maximum payload of a UDP segment towards socket::remote: the path MTU minus the IP and UDP headers. */
+static size_t socket_gso_size(struct node *n)
+{
+	int sd, mtu = SOCKET_MAX_PACKET_LEN;
+	socklen_t len = sizeof(mtu);
+	struct socket *s = (struct socket *) n->_vd;
+	int ipv6 = s->remote.sa.sa_family == AF_INET6;
+
+	/* IP_MTU is only available for connected sockets */
+	sd = socket(s->remote.sa.sa_family, SOCK_DGRAM, IPPROTO_UDP);
+	if (sd >= 0) {
+		if (connect(sd, (struct sockaddr *) &s->remote, sizeof(s->remote)) == 0 &&
+		    getsockopt(sd, ipv6 ? IPPROTO_IPV6 : IPPROTO_IP, ipv6 ? IPV6_MTU : IP_MTU, &mtu, &len))
+			mtu = SOCKET_MAX_PACKET_LEN;
+
+		close(sd);
+	}
+
+	return MIN(mtu, SOCKET_MAX_PACKET_LEN) - (ipv6 ? sizeof(struct ip6_hdr) : sizeof(struct ip)) - sizeof(struct udphdr);
+}
+
+/** Format one sample per segment into datagram \p i of the batch and let the kernel split it (UDP_SEGMENT).
+ *
+ * All segments of a datagram must have the same size. Only the last one might be shorter.
+ * A sample which does not fit is left for the next datagram.
+ * The kernel rejects segments which exceed the path MTU. So a sample which is larger than
+ * socket::gso_size is sent as a plain datagram which might be fragmented.
+ *
+ * @return The number of samples which have been formatted or -1 on error.
+ */
+static int socket_gso_pack(struct node *n, struct socket_batch *b, int i, struct sample *smps[], unsigned cnt)
+{
+	int ret, nsegs = 0;
+	struct socket *s = (struct socket *) n->_vd;
+
+	char *buf = b->iov[i].iov_base;
+	size_t off = 0, segsz = 0, wbytes;
+
+	while (nsegs < cnt && nsegs < SOCKET_GSO_MAX_SEGMENTS && b->size - off >= segsz) {
+		ret = io_format_sprint(s->format, buf + off, MIN(s->gso_size, b->size - off), &wbytes, &smps[nsegs], 1, SAMPLE_HAS_ALL);
+		if (ret < 0)
+			return -1;
+
+		if (ret == 0 || wbytes <= 0)
+			break;
+
+		if (nsegs == 0)
+			segsz = wbytes;
+		else if (wbytes > segsz)
+			break;
+
+		off += wbytes;
+		nsegs++;
+
+		if (wbytes < segsz)
+			break;
+	}
+
+	if (nsegs == 0) {
+		ret = io_format_sprint(s->format, buf, b->size, &wbytes, smps, 1, SAMPLE_HAS_ALL);
+		if (ret < 0)
+			return -1;
+
+		if (ret == 0 || wbytes <= 0)
+			return 0;
+
+		off = wbytes;
+		nsegs = 1;
+	}
+
+	b->iov[i].iov_len = off;
+
+	if (nsegs > 1)
+		*(uint16_t *) socket_batch_cmsg(b, i, SOL_UDP, UDP_SEGMENT, sizeof(uint16_t)) = segsz;
+
+	return nsegs;
+}
+#endif /* __linux__ */
+
+/** Receive up to socket_batch::len datagrams from \p sd with a single recvmmsg() and parse them into \p smps.
+ *
+ * @return The number of samples or -1 if recvmmsg() failed. errno is set accordingly.
+ */
+static int socket_recv_batch(struct node *n, int sd, struct socket_batch *b, struct sample *smps[], unsigned cnt)
+{
+	int ret, nmsgs, nread = 0;
+	struct socket *s = (struct socket *) n->_vd;
+
+	/* Every datagram contains at least one sample */
+	nmsgs = MAX(1, MIN(cnt, b->len));
+
+	for (int i = 0; i < nmsgs; i++) {
+		b->iov[i].iov_len = b->size;
+		b->msgs[i].msg_hdr.msg_namelen = sizeof(b->addrs[i]);
+		b->msgs[i].msg_hdr.msg_controllen = SOCKET_MAX_CTRL_LEN;
+	}
+
+	/* Receive next datagrams: only wait for the first one */
+	nmsgs = recvmmsg(sd, b->msgs, nmsgs, MSG_WAITFORONE, NULL);
+	if (nmsgs < 0)
+		return -1;
+
+	for (int i = 0; i < nmsgs; i++) {
+		struct timespec ts, *tsp = NULL;
+
+		if (nread >= cnt) {
+			warn("Dropped %d packets from node %s: no samples left", nmsgs - i, node_name(n));
+			break;
+		}
+
+#ifdef __linux__
+		if (s->timestamping && !socket_timestamping_rx(s, &b->msgs[i].msg_hdr, &ts))
+			tsp = &ts;
+#endif /* __linux__ */
+
+		char *bufptr = b->iov[i].iov_base;
+		ssize_t bytes = b->msgs[i].msg_len, segsz = bytes, off;
+
+#ifdef __linux__
+		/* A coalesced datagram consists of segments of equal size. Only the last one might be shorter. */
+		if (s->gso) {
+			segsz = socket_gro_size(&b->msgs[i].msg_hdr);
+			if (segsz <= 0)
+				segsz = bytes;
+		}
+#endif /* __linux__ */
+
+		for (off = 0; off < bytes && nread < cnt; off += segsz) {
+			ret = socket_read_packet(n, bufptr + off, MIN(segsz, bytes - off), &b->addrs[i], tsp, &smps[nread], cnt - nread);
+			if (ret < 0)
+				continue;
+
+			nread += ret;
+		}
+
+		if (off < bytes)
+			warn("Dropped %zd bytes of a coalesced packet from node %s: no samples left", bytes - off, node_name(n));
+	}
+
+	return nread;
+}
+
+#ifdef __linux__
+static void * socket_worker_run(void *ctx)
+{
+	int nalloc, nread, npushed, err;
+	struct socket_worker *w = (struct socket_worker *) ctx;
+	struct node *n = w->node;
+	struct socket *s = (struct socket *) n->_vd;
+	struct sample *smps[w->rx.len];
+
+	/* The worker is not cancelled: socket_workers_stop() sets socket_worker::stop and shuts down the socket */
+	while (!atomic_load(&w->stop)) {
+		nalloc = sample_alloc_many(&s->pool, smps, w->rx.len);
+		if (nalloc < w->rx.len)
+			warn("Pool underrun for node %s", node_name(n));
+
+		nread = socket_recv_batch(n, w->sd, &w->rx, smps, nalloc);
+		if (nread < 0) {
+			err = errno;
+
+			sample_free_many(smps, nalloc);
+
+			if (atomic_load(&w->stop))
+				break;
+
+			/* Interrupted calls and datagrams which have been dropped by the kernel */
+			if (err == EINTR || err == EAGAIN || err == ENOBUFS || err == ENOMEM || err == ECONNREFUSED)
+				continue;
+
+			warn("Receive worker of node %s failed: %s", node_name(n), strerror(err));
+			break;
+		}
+
+		npushed = queue_signalled_push_many(&s->queue, (void **) smps, nread);
+		if (npushed < nread)
+			warn("Queue overrun for node %s", node_name(n));
+
+		sample_free_many(&smps[npushed], nalloc - npushed);
+	}
+
+	return NULL;
+}
+
+/** Open the sockets of all workers but the first one which uses socket::sd and start the receive threads.
+ *
+ * A classic BPF program steers each datagram to the worker with index (CPU % socket::nworkers)
+ * where CPU is the processor which received the datagram. As receive side scaling of the NIC keeps all
+ * datagrams of a flow on the same CPU, datagrams of a single source are always handled by the same worker.
+ */
+static int socket_workers_start(struct node *n)
+{
+	int ret, ncpus = get_nprocs_conf();
+	struct socket *s = (struct socket *) n->_vd;
+
+	struct sock_filter code[] = {
+		{ BPF_LD  | BPF_W | BPF_ABS, 0, 0, SKF_AD_OFF + SKF_AD_CPU },
+		{ BPF_ALU | BPF_MOD | BPF_K, 0, 0, s->nworkers },
+		{ BPF_RET | BPF_A,           0, 0, 0 }
+	};
+	struct sock_fprog prog = {
+		.len = ARRAY_LEN(code),
+		.filter = code
+	};
+
+	ret = pool_init(&s->pool, DEFAULT_QUEUELEN + s->nworkers * n->vectorize, SAMPLE_LEN(n->samplelen), &memtype_hugepage);
+	if (ret)
+		return ret;
+
+	ret = queue_signalled_init(&s->queue, DEFAULT_QUEUELEN, &memtype_hugepage, QUEUE_SIGNALLED_EVENTFD);
+	if (ret)
+		return ret;
+
+	s->workers = alloc(s->nworkers * sizeof(struct socket_worker));
+
+	for (int i = 0; i < s->nworkers; i++) {
+		struct socket_worker *w = &s->workers[i];
+		int one = 1;
+
+		w->node = n;
+
+		atomic_init(&w->stop, false);
+
+		if (i == 0)
+			w->sd = s->sd;
+		else {
+			w->sd = socket(s->local.sa.sa_family, SOCK_DGRAM, IPPROTO_UDP);
+			if (w->sd < 0)
+				return -1;
+
+			ret = setsockopt(w->sd, SOL_SOCKET, SO_REUSEPORT, &one, sizeof(one));
+			if (ret)
+				return ret;
+
+			if (s->timestamping) {
+				ret = socket_timestamping_init(n, w->sd);
+				if (ret)
+					return ret;
+			}
+
+			if (s->gso) {
+				ret = setsockopt(w->sd, SOL_UDP, UDP_GRO, &one, sizeof(one));
+				if (ret)
+					return ret;
+			}
+
+			ret = bind(w->sd, (struct sockaddr *) &s->local, sizeof(s->local));
+			if (ret)
+				return ret;
+		}
+
+		ret = socket_batch_init(&w->rx, n->vectorize, s->gso ? SOCKET_GSO_MAX_LEN : SOCKET_MAX_PACKET_LEN);
+		if (ret)
+			return ret;
+	}
+
+	/* The program applies to the whole SO_REUSEPORT group */
+	ret = setsockopt(s->sd, SOL_SOCKET, SO_ATTACH_REUSEPORT_CBPF, &prog, sizeof(prog));
+	if (ret)
+		return ret;
+
+	for (int i = 0; i < s->nworkers; i++) {
+		struct socket_worker *w = &s->workers[i];
+		cpu_set_t cset;
+
+		ret = pthread_create(&w->thread, NULL, socket_worker_run, w);
+		if (ret)
+			return ret;
+
+		/* Run each worker on the CPUs whose datagrams are steered to it */
+		CPU_ZERO(&cset);
+		for (int cpu = i; cpu < ncpus && cpu < CPU_SETSIZE; cpu += s->nworkers)
+			CPU_SET(cpu, &cset);
+
+		if (CPU_COUNT(&cset) > 0) {
+			ret = pthread_setaffinity_np(w->thread, sizeof(cset), &cset);
+			if (ret)
+				warn("Failed to set affinity of receive worker %d of node %s", i, node_name(n));
+		}
+	}
+
+	debug(LOG_SOCKET | 4, "Started %d receive workers for node %s", s->nworkers, node_name(n));
+
+	return 0;
+}
+
+static int socket_workers_stop(struct node *n)
+{
+	int ret;
+	struct socket *s = (struct socket *) n->_vd;
+
+	if (!s->workers)
+		return 0;
+
+	/* Wake up all workers which are blocked in recvmmsg().
+	 * shutdown() fails with ENOTCONN for unconnected sockets, but still takes effect. */
+	for (int i = 0; i < s->nworkers; i++) {
+		struct socket_worker *w = &s->workers[i];
+
+		atomic_store(&w->stop, true);
 
-	char *local = socket_print_addr((struct sockaddr *) &s->local);
-	char *remote = socket_print_addr((struct sockaddr *) &s->remote);
+		shutdown(w->sd, SHUT_RD);
+	}
 
-	buf = strf("layer=%s, format=%s, local=%s, remote=%s", layer, plugin_name(s->format), local, remote);
+	for (int i = 0; i < s->nworkers; i++) {
+		struct socket_worker *w = &s->workers[i];
 
-	if (s->multicast.enabled) {
-		char group[INET_ADDRSTRLEN];
-		char interface[INET_ADDRSTRLEN];
+		ret = pthread_join(w->thread, NULL);
+		if (ret)
+			return ret;
 
-		inet_ntop(AF_INET, &s->multicast.mreq.imr_multiaddr, group, sizeof(group));
-		inet_ntop(AF_INET, &s->multicast.mreq.imr_interface, interface, sizeof(interface));
+		if (i > 0)
+			close(w->sd);
 
-		strcatf(&buf, ", multicast.enabled=%s", s->multicast.enabled ? "yes" : "no");
-		strcatf(&buf, ", multicast.loop=%s",    s->multicast.loop    ? "yes" : "no");
-		strcatf(&buf, ", multicast.group=%s", group);
-		strcatf(&buf, ", multicast.interface=%s", s->multicast.mreq.imr_interface.s_addr == INADDR_ANY ? "any" : interface);
-		strcatf(&buf, ", multicast.ttl=%u", s->multicast.ttl);
+		socket_batch_destroy(&w->rx);
 	}
 
-	free(local);
-	free(remote);
+	free(s->workers);
+	s->workers = NULL;
 
-	return buf;
+	ret = queue_signalled_destroy(&s->queue);
+	if (ret)
+		return ret;
+
+	return pool_destroy(&s->pool);
 }
+#endif /* __linux__ */
 
 int socket_start(struct node *n)
 {
@@ -203,12 +1407,51 @@ int socket_start(struct node *n)
 	if (s->sd < 0)
 		serror("Failed to create socket");
 
+#ifdef __linux__
+	/* The rings must be set up before binding so that no frames end up in the regular receive queue */
+	if (s->ring.enabled) {
+		ret = socket_ring_init(s);
+		if (ret)
+			serror("Failed to setup PACKET_MMAP ring for node %s", node_name(n));
+	}
+#endif /* __linux__ */
+
+#ifdef __linux__
+	/* All workers share the local address */
+	if (s->nworkers > 1) {
+		int one = 1;
+
+		ret = setsockopt(s->sd, SOL_SOCKET, SO_REUSEPORT, &one, sizeof(one));
+		if (ret)
+			serror("Failed to enable SO_REUSEPORT for node %s", node_name(n));
+	}
+#endif /* __linux__ */
+
 	/* Bind socket for receiving */
 	ret = bind(s->sd, (struct sockaddr *) &s->local, sizeof(s->local));
 	if (ret < 0)
 		serror("Failed to bind socket");
 
 #ifdef __linux__
+	if (s->timestamping) {
+		ret = socket_timestamping_init(n, s->sd);
+		if (ret)
+			serror("Failed to enable timestamping for node %s", node_name(n));
+	}
+
+	/* Let the kernel coalesce received datagrams. socket_recv_batch() splits them again. */
+	if (s->gso) {
+		int one = 1;
+
+		s->gso_size = socket_gso_size(n);
+
+		debug(LOG_SOCKET | 4, "Using UDP segments of up to %zu bytes for node %s", s->gso_size, node_name(n));
+
+		ret = setsockopt(s->sd, SOL_UDP, UDP_GRO, &one, sizeof(one));
+		if (ret)
+			serror("Failed to enable UDP_GRO for node %s", node_name(n));
+	}
+
 	/* Set fwmark for outgoing packets if netem is enabled for this node */
 	if (s->mark) {
 		ret = setsockopt(s->sd, SOL_SOCKET, SO_MARK, &s->mark, sizeof(s->mark));
@@ -233,6 +1476,61 @@ int socket_start(struct node *n)
 			serror("Failed to join multicast group");
 	}
 
+	/* Buffers for up to node::vectorize datagrams per recvmmsg() / sendmmsg() */
+#ifdef __linux__
+	if (!s->ring.enabled) {
+#endif /* __linux__ */
+		ret = socket_batch_init(&s->rx, n->vectorize, s->gso ? SOCKET_GSO_MAX_LEN : SOCKET_MAX_PACKET_LEN);
+		if (ret)
+			return ret;
+
+		/* Zerocopy sends use the buffers of socket::zc instead */
+		ret = socket_batch_init(&s->tx, n->vectorize, s->zerocopy ? 0 : s->gso ? SOCKET_GSO_MAX_LEN : SOCKET_MAX_PACKET_LEN);
+		if (ret)
+			return ret;
+
+		for (int i = 0; i < s->tx.len; i++) {
+			s->tx.msgs[i].msg_hdr.msg_name = &s->remote;
+			s->tx.msgs[i].msg_hdr.msg_namelen = sizeof(s->remote);
+			s->tx.msgs[i].msg_hdr.msg_control = NULL;
+			s->tx.msgs[i].msg_hdr.msg_controllen = 0;
+		}
+#ifdef __linux__
+	}
+#endif /* __linux__ */
+
+#ifdef __linux__
+	if (s->txtime.enabled) {
+		ret = socket_txtime_init(n);
+		if (ret)
+			serror("Failed to enable SO_TXTIME for node %s", node_name(n));
+	}
+
+	if (s->zerocopy) {
+		ret = socket_zerocopy_init(n);
+		if (ret)
+			serror("Failed to enable MSG_ZEROCOPY for node %s", node_name(n));
+
+		s->tx.size = SOCKET_GSO_MAX_LEN;
+	}
+#endif /* __linux__ */
+
+#ifdef WITH_LIBURING
+	if (s->io_uring) {
+		ret = socket_uring_init(n);
+		if (ret)
+			serror("Failed to setup io_uring for node %s", node_name(n));
+	}
+#endif /* WITH_LIBURING */
+
+#ifdef __linux__
+	if (s->nworkers > 1) {
+		ret = socket_workers_start(n);
+		if (ret)
+			serror("Failed to start receive workers of node %s", node_name(n));
+	}
+#endif /* __linux__ */
+
 	/* Set socket priority, QoS or TOS IP options */
 	int prio;
 	switch (s->layer) {
@@ -278,15 +1576,42 @@ int socket_stop(struct node *n)
 	int ret;
 	struct socket *s = (struct socket *) n->_vd;
 
+#ifdef __linux__
+	ret = socket_workers_stop(n);
+	if (ret)
+		serror("Failed to stop receive workers of node %s", node_name(n));
+#endif /* __linux__ */
+
 	if (s->multicast.enabled) {
 		ret = setsockopt(s->sd, IPPROTO_IP, IP_DROP_MEMBERSHIP, &s->multicast.mreq, sizeof(s->multicast.mreq));
 		if (ret)
 			serror("Failed to leave multicast group");
 	}
 
+#ifdef __linux__
+	ret = socket_ring_destroy(s);
+	if (ret)
+		serror("Failed to unmap PACKET_MMAP ring of node %s", node_name(n));
+#endif /* __linux__ */
+
+#ifdef WITH_LIBURING
+	ret = socket_uring_destroy(n);
+	if (ret)
+		serror("Failed to destroy io_uring of node %s", node_name(n));
+#endif /* WITH_LIBURING */
+
 	if (s->sd >= 0)
 		close(s->sd);
 
+#ifdef __linux__
+	ret = socket_zerocopy_destroy(n);
+	if (ret)
+		serror("Failed to release zerocopy buffers of node %s", node_name(n));
+#endif /* __linux__ */
+
+	socket_batch_destroy(&s->rx);
+	socket_batch_destroy(&s->tx);
+
 	return 0;
 }
 
@@ -307,48 +1632,35 @@ int socket_read(struct node *n, struct sample *smps[], unsigned cnt)
 	int ret;
 	struct socket *s = (struct socket *) n->_vd;
 
-	char buf[SOCKET_MAX_PACKET_LEN];
-	char *bufptr = buf;
-	ssize_t bytes;
-	size_t rbytes;
-
-	union sockaddr_union src;
-	socklen_t srclen = sizeof(src);
+#ifdef __linux__
+	if (s->ring.enabled)
+		return socket_ring_read(n, smps, cnt);
+#endif /* __linux__ */
 
-	/* Receive next sample */
-	bytes = recvfrom(s->sd, bufptr, sizeof(buf), 0, &src.sa, &srclen);
-	if (bytes < 0)
-		serror("Failed recv from node %s", node_name(n));
+#ifdef WITH_LIBURING
+	if (s->io_uring)
+		return socket_uring_read(n, smps, cnt);
+#endif /* WITH_LIBURING */
 
-	/* Strip IP header from packet */
-	if (s->layer == SOCKET_LAYER_IP) {
-		struct ip *iphdr = (struct ip *) bufptr;
+#ifdef __linux__
+	if (s->nworkers > 1) {
+		int avail;
+		struct sample *cpys[cnt];
 
-		bytes  -= iphdr->ip_hl * 4;
-		bufptr += iphdr->ip_hl * 4;
-	}
+		avail = queue_signalled_pull_many(&s->queue, (void **) cpys, cnt);
 
-	/* SOCK_RAW IP sockets to not provide the IP protocol number via recvmsg()
-	 * So we simply set it ourself. */
-	if (s->layer == SOCKET_LAYER_IP) {
-		switch (src.sa.sa_family) {
-			case AF_INET: src.sin.sin_port = s->remote.sin.sin_port; break;
-			case AF_INET6: src.sin6.sin6_port = s->remote.sin6.sin6_port; break;
+		for (int i = 0; i < avail; i++) {
+			sample_copy(smps[i], cpys[i]);
+			sample_put(cpys[i]);
 		}
-	}
-
-	if (s->verify_source && socket_compare_addr(&src.sa, &s->remote.sa) != 0) {
-		char *buf = socket_print_addr((struct sockaddr *) &src);
-		warn("Received packet from unauthorized source: %s", buf);
-		free(buf);
 
-		return 0;
+		return avail;
 	}
+#endif /* __linux__ */
 
-	ret = io_format_sscan(s->format, bufptr, bytes, &rbytes, smps, cnt, 0);
-
-	if (bytes != rbytes)
-		warn("Received invalid packet from node: %s bytes=%zu, rbytes=%zu", node_name(n), bytes, rbytes);
+	ret = socket_recv_batch(n, s->sd, &s->rx, smps, cnt);
+	if (ret < 0)
+		serror("Failed recv from node %s", node_name(n));
 
 	return ret;
 }
@@ -356,32 +1668,153 @@ int socket_read(struct node *n, struct sample *smps[], unsigned cnt)
 int socket_write(struct node *n, struct sample *smps[], unsigned cnt)
 {
 	struct socket *s = (struct socket *) n->_vd;
+	struct socket_batch *b = &s->tx;
 
-	char data[SOCKET_MAX_PACKET_LEN];
-	int ret;
-	ssize_t bytes;
+	int ret = 0, flags = 0, nmsgs = 0, sent = 0;
+	unsigned nwritten = 0;
 	size_t wbytes;
 
-	ret = io_format_sprint(s->format, data, sizeof(data), &wbytes, smps, cnt, SAMPLE_HAS_ALL);
-	if (ret < 0)
+#ifdef __linux__
+	if (s->ring.enabled)
+		return socket_ring_write(n, smps, cnt);
+#endif /* __linux__ */
+
+#ifdef WITH_LIBURING
+	/* The kernel might still use the buffers of the previous batch */
+	if (s->io_uring) {
+		ret = uring_wait(&s->tx_uring);
+		if (ret)
+			warn("Failed send to node %s: %s", node_name(n), strerror(errno));
+	}
+#endif /* WITH_LIBURING */
+
+	/* Pack as many samples as possible into each datagram */
+	while (nwritten < cnt && nmsgs < b->len) {
+		/* Control messages are appended by socket_batch_cmsg() */
+		b->msgs[nmsgs].msg_hdr.msg_control = NULL;
+		b->msgs[nmsgs].msg_hdr.msg_controllen = 0;
+
+#ifdef __linux__
+		/* Format directly into a buffer which is pinned by the kernel until the send has completed */
+		if (s->zerocopy)
+			b->iov[nmsgs].iov_base = socket_zerocopy_get(n);
+
+		if (s->gso) {
+			ret = socket_gso_pack(n, b, nmsgs, &smps[nwritten], cnt - nwritten);
+			if (ret <= 0)
+				break;
+
+			b->first[nmsgs] = nwritten;
+
+			nwritten += ret;
+			nmsgs++;
+
+			continue;
+		}
+#endif /* __linux__ */
+
+		ret = io_format_sprint(s->format, b->iov[nmsgs].iov_base, b->size, &wbytes, &smps[nwritten], cnt - nwritten, SAMPLE_HAS_ALL);
+		if (ret <= 0 || wbytes <= 0)
+			break;
+
+		b->iov[nmsgs].iov_len = wbytes;
+		b->first[nmsgs] = nwritten;
+
+		nwritten += ret;
+		nmsgs++;
+	}
+
+#ifdef __linux__
+	/* The loop has been left early: the last buffer has not been used */
+	if (s->zerocopy && nwritten < cnt && nmsgs < b->len)
+		pool_put(&s->zc.pool, b->iov[nmsgs].iov_base);
+
+	if (s->zerocopy)
+		flags |= MSG_ZEROCOPY;
+#endif /* __linux__ */
+
+	if (ret < 0) {
+#ifdef __linux__
+		/* None of the formatted datagrams will be sent */
+		if (s->zerocopy) {
+			for (int i = 0; i < nmsgs; i++)
+				pool_put(&s->zc.pool, b->iov[i].iov_base);
+		}
+#endif /* __linux__ */
+
 		return -1;
+	}
+
+#ifdef __linux__
+	if (s->txtime.enabled && nmsgs > 0)
+		socket_txtime_set(n, b, smps, nmsgs);
+#endif /* __linux__ */
+
+	b->first[nmsgs] = nwritten;
 
-	if (wbytes <= 0)
+	if (nmsgs == 0)
 		return 0;
 
-	/* Send message */
-	bytes = sendto(s->sd, data, wbytes, 0, (struct sockaddr *) &s->remote, sizeof(s->remote));
-	if (bytes < 0) {
-		if (errno == EPERM)
-			warn("Failed send to node %s: %s", node_name(n), strerror(errno));
-		else
+#ifdef WITH_LIBURING
+	/* Queue one sendmsg() per datagram and submit them with a single system call.
+	 * The completions are reaped by the next call of socket_write(). */
+	if (s->io_uring) {
+		for (int i = 0; i < nmsgs; i++) {
+			struct io_uring_sqe *sqe = uring_get_sqe(&s->tx_uring);
+			if (!sqe)
+				serror("Failed to queue send to node %s", node_name(n));
+
+			io_uring_prep_sendmsg(sqe, s->sd, &b->msgs[i].msg_hdr, 0);
+		}
+
+		ret = uring_submit(&s->tx_uring);
+		if (ret < 0)
 			serror("Failed send to node %s", node_name(n));
+
+		return nwritten;
+	}
+#endif /* WITH_LIBURING */
+
+	/* Send messages */
+	while (sent < nmsgs) {
+		ret = sendmmsg(s->sd, &b->msgs[sent], nmsgs - sent, flags);
+		if (ret < 0) {
+			if (errno == EPERM) {
+				warn("Failed send to node %s: %s", node_name(n), strerror(errno));
+				break;
+			}
+			else
+				serror("Failed send to node %s", node_name(n));
+		}
+
+		for (int i = sent; i < sent + ret; i++) {
+			if (b->msgs[i].msg_len != b->iov[i].iov_len)
+				warn("Partial send to node %s", node_name(n));
+
+#ifdef __linux__
+			if (s->zerocopy)
+				socket_zerocopy_track(n, b->iov[i].iov_base);
+#endif /* __linux__ */
+		}
+
+		sent += ret;
+	}
+
+#ifdef __linux__
+	/* Buffers of datagrams which have not been sent are not referenced by the kernel */
+	if (s->zerocopy) {
+		for (int i = sent; i < nmsgs; i++)
+			pool_put(&s->zc.pool, b->iov[i].iov_base);
 	}
 
-	if (bytes != wbytes)
-		warn("Partial send to node %s", node_name(n));
+	if (s->timestamping)
+		s->tx_key += sent;
+
+	if (s->timestamping || s->zerocopy || s->txtime.enabled)
+		socket_errqueue(n, smps, sent);
+#endif /* __linux__ */
 
-	return cnt;
+	return nwritten;
 }
 
 int socket_parse(struct node *n, json_t *cfg)
@@ -390,28 +1823,62 @@ int socket_parse(struct node *n, json_t *cfg)
 
 	const char *local, *remote;
 	const char *layer = NULL;
+	const char *timestamping = NULL;
 	const char *format = "villas-binary";
 
 	int ret;
 
 	json_t *json_multicast = NULL;
+	json_t *json_ring = NULL;
+	json_t *json_txtime = NULL;
 	json_error_t err;
 
 	/* Default values */
 	s->layer = SOCKET_LAYER_UDP;
 	s->verify_source = 0;
+	s->io_uring = 0;
+	s->nworkers = 1;
+	s->gso = 0;
+	s->zerocopy = 0;
 
-	ret = json_unpack_ex(cfg, &err, 0, "{ s?: s, s: s, s: s, s?: b, s?: o, s?: s }",
+	ret = json_unpack_ex(cfg, &err, 0, "{ s?: s, s: s, s: s, s?: b, s?: o, s?: o, s?: s, s?: b, s?: i, s?: b, s?: b, s?: o, s?: s }",
 		"layer", &layer,
 		"remote", &remote,
 		"local", &local,
 		"verify_source", &s->verify_source,
 		"multicast", &json_multicast,
+		"ring", &json_ring,
+		"timestamping", &timestamping,
+		"io_uring", &s->io_uring,
+		"workers", &s->nworkers,
+		"gso", &s->gso,
+		"zerocopy", &s->zerocopy,
+		"txtime", &json_txtime,
 		"format", &format
 	);
 	if (ret)
 		jerror(&err, "Failed to parse configuration of node %s", node_name(n));
 
+#ifndef WITH_LIBURING
+	if (s->io_uring)
+		error("Setting 'io_uring' of node %s requires VILLASnode to be built with liburing", node_name(n));
+#endif /* WITH_LIBURING */
+
+	/* Timestamping */
+	s->timestamping = SOCKET_TIMESTAMPING_NONE;
+	if (timestamping) {
+		if (!strcmp(timestamping, "none"))
+			s->timestamping = SOCKET_TIMESTAMPING_NONE;
+#ifdef __linux__
+		else if (!strcmp(timestamping, "software"))
+			s->timestamping = SOCKET_TIMESTAMPING_SOFTWARE;
+		else if (!strcmp(timestamping, "hardware"))
+			s->timestamping = SOCKET_TIMESTAMPING_HARDWARE;
+#endif /* __linux__ */
+		else
+			error("Invalid timestamping mode '%s' for node %s", timestamping, node_name(n));
+	}
+
 	/* Format */
 	s->format = io_format_lookup(format);
 	if (!s->format)
@@ -431,6 +1898,45 @@ int socket_parse(struct node *n, json_t *cfg)
 			error("Invalid layer '%s' for node %s", layer, node_name(n));
 	}
 
+	if (s->gso) {
+#ifdef __linux__
+		if (s->layer != SOCKET_LAYER_UDP)
+			error("Setting 'gso' of node %s is only supported by layer 'udp'", node_name(n));
+
+		if (s->io_uring)
+			error("Settings 'gso' and 'io_uring' of node %s are mutually exclusive", node_name(n));
+#else
+		error("Setting 'gso' of node %s is not supported on this platform", node_name(n));
+#endif /* __linux__ */
+	}
+
+	if (s->zerocopy) {
+#ifdef __linux__
+		if (s->layer != SOCKET_LAYER_UDP)
+			error("Setting 'zerocopy' of node %s is only supported by layer 'udp'", node_name(n));
+
+		if (s->io_uring)
+			error("Settings 'zerocopy' and 'io_uring' of node %s are mutually exclusive", node_name(n));
+#else
+		error("Setting 'zerocopy' of node %s is not supported on this platform", node_name(n));
+#endif /* __linux__ */
+	}
+
+	if (s->nworkers < 1)
+		error("Setting 'workers' of node %s must be a positive number", node_name(n));
+
+	if (s->nworkers > 1) {
+#ifdef __linux__
+		if (s->layer != SOCKET_LAYER_UDP)
+			error("Setting 'workers' of node %s is only supported by layer 'udp'", node_name(n));
+
+		if (s->io_uring || json_ring || json_multicast)
+			error("Setting 'workers' of node %s can not be combined with 'io_uring', 'ring' or 'multicast'", node_name(n));
+#else
+		error("Setting 'workers' of node %s is not supported on this platform", node_name(n));
+#endif /* __linux__ */
+	}
+
 	ret = socket_parse_addr(local, (struct sockaddr *) &s->local, s->layer, AI_PASSIVE);
 	if (ret) {
 		error("Failed to resolve local address '%s' of node %s: %s",
@@ -477,6 +1983,89 @@ int socket_parse(struct node *n, json_t *cfg)
 		}
 	}
 
+	if (json_ring) {
+#ifdef __linux__
+		int block_size = 1 << 16;
+		int blocks = 64;
+		int frame_size = 2048;
+		int timeout = 1;
+
+		/* Default values */
+		s->ring.enabled = true;
+
+		ret = json_unpack_ex(json_ring, &err, 0, "{ s?: b, s?: i, s?: i, s?: i, s?: i }",
+			"enabled", &s->ring.enabled,
+			"block_size", &block_size,
+			"blocks", &blocks,
+			"frame_size", &frame_size,
+			"timeout", &timeout
+		);
+		if (ret)
+			jerror(&err, "Failed to parse setting 'ring' of node %s", node_name(n));
+
+		if (s->ring.enabled && s->layer != SOCKET_LAYER_ETH)
+			error("Setting 'ring' of node %s is only supported by layer 'eth'", node_name(n));
+
+		if (s->ring.enabled && s->io_uring)
+			error("Settings 'ring' and 'io_uring' of node %s are mutually exclusive", node_name(n));
+
+		if (block_size <= 0 || block_size % getpagesize())
+			error("Setting 'ring.block_size' of node %s must be a multiple of the page size (%d)", node_name(n), getpagesize());
+
+		if (frame_size < TPACKET3_HDRLEN || frame_size % TPACKET_ALIGNMENT || block_size % frame_size)
+			error("Setting 'ring.frame_size' of node %s must be a multiple of %d which divides 'ring.block_size'", node_name(n), TPACKET_ALIGNMENT);
+
+		if (blocks <= 0 || timeout < 0)
+			error("Invalid setting 'ring' of node %s", node_name(n));
+
+		s->ring.req.tp_block_size = block_size;
+		s->ring.req.tp_block_nr = blocks;
+		s->ring.req.tp_frame_size = frame_size;
+		s->ring.req.tp_retire_blk_tov = timeout;
+#else
+		error("Setting 'ring' of node %s is not supported on this platform", node_name(n));
+#endif /* __linux__ */
+	}
+
+	if (json_txtime) {
+#ifdef __linux__
+		const char *clock = NULL;
+		double offset;
+
+		/* Default values */
+		s->txtime.enabled = true;
+		s->txtime.deadline = false;
+		s->txtime.clock = CLOCK_TAI;
+
+		ret = json_unpack_ex(json_txtime, &err, 0, "{ s?: b, s: F, s?: s, s?: b }",
+			"enabled", &s->txtime.enabled,
+			"offset", &offset,
+			"clock", &clock,
+			"deadline", &s->txtime.deadline
+		);
+		if (ret)
+			jerror(&err, "Failed to parse setting 'txtime' of node %s", node_name(n));
+
+		if (clock) {
+			if (!strcmp(clock, "tai"))
+				s->txtime.clock = CLOCK_TAI;
+			else if (!strcmp(clock, "monotonic"))
+				s->txtime.clock = CLOCK_MONOTONIC;
+			else if (!strcmp(clock, "realtime"))
+				s->txtime.clock = CLOCK_REALTIME;
+			else
+				error("Invalid setting 'txtime.clock' of node %s: %s", node_name(n), clock);
+		}
+
+		if (s->txtime.enabled && s->ring.enabled)
+			error("Settings 'txtime' and 'ring' of node %s are mutually exclusive", node_name(n));
+
+		s->txtime.offset = offset * 1e9;
+#else
+		error("Setting 'txtime' of node %s is not supported on this platform", node_name(n));
+#endif /* __linux__ */
+	}
+
 #ifdef WITH_NETEM
 	json_t *json_netem;
 
@@ -687,9 +2276,63 @@ int socket_fd(struct node *n)
 {
 	struct socket *s = (struct socket *) n->_vd;
 
+#ifdef WITH_LIBURING
+	/* The socket itself never becomes readable while a multishot receive is armed */
+	if (s->io_uring)
+		return s->rx_uring.ring.ring_fd;
+#endif /* WITH_LIBURING */
+
+#ifdef __linux__
+	if (s->nworkers > 1)
+		return queue_signalled_fd(&s->queue);
+#endif /* __linux__ */
+
 	return s->sd;
 }
 
+int socket_poll_error(struct node *n)
+{
+#ifdef __linux__
+	int ret, err;
+	socklen_t len = sizeof(err);
+	struct socket *s = (struct socket *) n->_vd;
+
+	/* Zerocopy completions, transmit timestamps and datagrams which have been dropped by the ETF qdisc.
+	 * They usually arrive after socket_write() has returned. */
+	socket_errqueue(n, NULL, 0);
+
+	/* Asynchronous errors like ICMP port unreachable keep POLLERR set until they are read */
+	ret = getsockopt(s->sd, SOL_SOCKET, SO_ERROR, &err, &len);
+	if (ret)
+		return ret;
+
+	if (err)
+		warn("Node %s reported an error: %s", node_name(n), strerror(err));
+
+	return 0;
+#else
+	return -1;
+#endif /* __linux__ */
+}
+
+size_t socket_footprint(struct node *n)
+{
+	size_t len = 0;
+	struct socket *s = (struct socket *) n->_vd;
+
+#ifdef __linux__
+	if (s->nworkers > 1) {
+		len += pool_footprint(DEFAULT_QUEUELEN + s->nworkers * n->vectorize, SAMPLE_LEN(n->samplelen), 0);
+		len += queue_footprint(DEFAULT_QUEUELEN);
+	}
+
+	if (s->zerocopy)
+		len += pool_footprint_aligned(SOCKET_ZEROCOPY_DEPTH * n->vectorize, ALIGN(SOCKET_GSO_MAX_LEN, getpagesize()), getpagesize(), 0);
+#endif /* __linux__ */
+
+	return len;
+}
+
 static struct plugin p = {
 	.name		= "socket",
 	.description	= "BSD network sockets for Ethernet / IP / UDP (libnl3)",
@@ -707,7 +2350,9 @@ static struct plugin p = {
 		.write		= socket_write,
 		.init		= socket_init,
 		.deinit		= socket_deinit,
-		.fd		= socket_fd
+		.fd		= socket_fd,
+		.footprint	= socket_footprint,
+		.poll_error	= socket_poll_error
 	}
 };
 
@@ -173,7 +173,8 @@ int websocket_protocol_cb(struct lws *wsi, enum lws_callback_reasons reason, voi
 			buffer_init(&c->buffers.recv, 1 << 12);
 			buffer_init(&c->buffers.send, 1 << 12);
 
-			ret = queue_init(&c->queue, DEFAULT_QUEUELEN, &memtype_hugepage);
+			/* Incoming connections are not known in advance and can not be planned in the hugepage arena */
+			ret = queue_init(&c->queue, DEFAULT_QUEUELEN, &memtype_heap, QUEUE_MPMC);
 			if (ret)
 				return -1;
 
@@ -369,7 +370,7 @@ int websocket_start(struct node *n)
 		d->info.vhost = web->vhost;
 		d->info.userdata = c;
 
-		ret = queue_init(&c->queue, DEFAULT_QUEUELEN, &memtype_hugepage);
+		ret = queue_init(&c->queue, DEFAULT_QUEUELEN, &memtype_hugepage, QUEUE_MPMC);
 		if (ret)
 			return -1;
 
@@ -381,6 +382,15 @@ int websocket_start(struct node *n)
 	return 0;
 }
 
+size_t websocket_footprint(struct node *n)
+{
+	struct websocket *w = (struct websocket *) n->_vd;
+
+	return pool_footprint(DEFAULT_WEBSOCKET_QUEUELEN, SAMPLE_LEN(DEFAULT_WEBSOCKET_SAMPLELEN), 0)
+		+ queue_footprint(DEFAULT_WEBSOCKET_QUEUELEN)
+		+ list_length(&w->destinations) * queue_footprint(DEFAULT_QUEUELEN);
+}
+
 int websocket_stop(struct node *n)
 {
 	int ret;
@@ -568,6 +578,13 @@ int websocket_fd(struct node *n)
 	return queue_signalled_fd(&w->queue);
 }
 
+int websocket_available(struct node *n)
+{
+	struct websocket *w = (struct websocket *) n->_vd;
+
+	return queue_signalled_available(&w->queue);
+}
+
 static struct plugin p = {
 	.name		= "websocket",
 	.description	= "Send and receive samples of a WebSocket connection (libwebsockets)",
@@ -584,7 +601,9 @@ static struct plugin p = {
 		.write		= websocket_write,
 		.print		= websocket_print,
 		.parse		= websocket_parse,
-		.fd		= websocket_fd
+		.fd		= websocket_fd,
+		.available	= websocket_available,
+		.footprint	= websocket_footprint
 	}
 };
 
@@ -24,8 +24,10 @@
 #include <stdint.h>
 #include <unistd.h>
 #include <string.h>
+#include <strings.h>
 #include <inttypes.h>
 #include <poll.h>
+#include <sched.h>
 
 #include "config.h"
 #include "utils.h"
@@ -38,15 +40,71 @@
 #include "memory.h"
 #include "stats.h"
 #include "node.h"
+#include "kernel/kernel.h"
 
-static int path_source_init(struct path_source *ps)
+/** Get the memory type for the buffers which the path shares with the stage dedicated to node \p n. */
+static struct memtype * path_memtype(struct path *p, struct node *n)
+{
+	/* The stages of a pipelined path run with the settings of their node */
+	if (p->pipeline && n->numa_node >= 0)
+		return memtype_numa(n->numa_node);
+
+	return memtype_numa(p->numa_node);
+}
+
+/** Get the number of blocks which the magazine caches of the threads of a path may withhold from one of its pools.
+ *
+ * The pools are enlarged by this number so that the path can not starve itself.
+ */
+static size_t path_pool_reserve(struct path *p)
+{
+	/* The path thread or the reader, processing and writer stages of a pipelined path */
+	size_t threads = p->pipeline
+		? 1 + list_length(&p->sources) + list_length(&p->destinations)
+		: 1;
+
+	return threads * p->pool_cache;
+}
+
+static int path_source_init(struct path_source *ps, struct path *p)
 {
 	int ret;
 
-	ret = pool_init(&ps->pool, MAX(DEFAULT_QUEUELEN, ps->node->vectorize), SAMPLE_LEN(ps->node->samplelen), &memtype_hugepage);
+	ps->path = p;
+
+	ret = mapping_plan_init(&ps->plan, &ps->mappings, NULL);
+	if (ret) {
+		warn("Failed to compile mappings of source %s of path %s", node_name(ps->node), path_name(p));
+		return ret;
+	}
+
+	ret = pool_init(&ps->pool, MAX(DEFAULT_QUEUELEN, ps->node->vectorize) + path_pool_reserve(p), SAMPLE_LEN(ps->node->samplelen), path_memtype(p, ps->node));
+	if (ret)
+		return ret;
+
+	ret = pool_cache_init(&ps->pool, p->pool_cache);
 	if (ret)
 		return ret;
 
+	if (p->occupancy)
+		pool_occupancy_enable(&ps->pool);
+
+	/* The processing stage of a pipelined path poll()s for new samples of the reader stage.
+	 * A busy-polling processing stage checks the queue directly and needs no notifications.
+	 * The reader stage is the only producer and the processing stage the only consumer. */
+	if (p->pipeline) {
+		int flags = QUEUE_SIGNALLED_SPSC;
+
+		flags |= p->polling ? QUEUE_SIGNALLED_POLLING : QUEUE_SIGNALLED_EVENTFD;
+
+		if (p->occupancy)
+			flags |= QUEUE_SIGNALLED_OCCUPANCY;
+
+		ret = queue_signalled_init(&ps->queue, p->queuelen, path_memtype(p, ps->node), flags);
+		if (ret)
+			return ret;
+	}
+
 	return 0;
 }
 
@@ -58,6 +116,16 @@ static int path_source_destroy(struct path_source *ps)
 	if (ret)
 		return ret;
 
+	if (ps->queue.queue.state != STATE_DESTROYED) {
+		ret = queue_signalled_destroy(&ps->queue);
+		if (ret)
+			return ret;
+	}
+
+	ret = mapping_plan_destroy(&ps->plan);
+	if (ret)
+		return ret;
+
 	ret = list_destroy(&ps->mappings, NULL, true);
 	if (ret)
 		return ret;
@@ -65,11 +133,24 @@ static int path_source_destroy(struct path_source *ps)
 	return 0;
 }
 
-static int path_destination_init(struct path_destination *pd, int queuelen)
+static int path_destination_init(struct path_destination *pd, struct path *p)
 {
 	int ret;
 
-	ret = queue_init(&pd->queue, queuelen, &memtype_hugepage);
+	pd->path = p;
+
+	/* Only the writer stage of a pipelined path waits for new samples */
+	int flags = p->pipeline ? QUEUE_SIGNALLED_EVENTFD : QUEUE_SIGNALLED_POLLING;
+
+	/* The path thread is the only producer. Without a writer stage it is also the only consumer.
+	 * Evicting samples with PATH_OVERFLOW_DROP_OLDEST makes it a second consumer of the writer stage's queue. */
+	if (!p->pipeline || pd->overflow != PATH_OVERFLOW_DROP_OLDEST)
+		flags |= QUEUE_SIGNALLED_SPSC;
+
+	if (p->occupancy)
+		flags |= QUEUE_SIGNALLED_OCCUPANCY;
+
+	ret = queue_signalled_init(&pd->queue, p->queuelen, path_memtype(p, pd->node), flags);
 	if (ret)
 		return ret;
 
@@ -80,158 +161,562 @@ static int path_destination_destroy(struct path_destination *pd)
 {
 	int ret;
 
-	ret = queue_destroy(&pd->queue);
+	if (pd->queue.queue.state == STATE_DESTROYED)
+		return 0;
+
+	ret = queue_signalled_destroy(&pd->queue);
 	if (ret)
 		return ret;
 
 	return 0;
 }
 
+static void path_destination_write(struct path *p, struct path_destination *pd, struct sample *smps[], unsigned cnt)
+{
+	int sent, released;
+
+	debug(LOG_PATH | 15, "Dequeued %u samples from queue of node %s which is part of path %s", cnt, node_name(pd->node), path_name(p));
+
+	sent = node_write(pd->node, smps, cnt);
+	if (sent < 0)
+		error("Failed to sent %u samples to node %s", cnt, node_name(pd->node));
+	else if (sent < cnt)
+		warn("Partial write to node %s: written=%d, expected=%d", node_name(pd->node), sent, cnt);
+
+	released = sample_put_many(smps, cnt);
+
+	debug(LOG_PATH | 15, "Released %d samples back to memory pool", released);
+}
+
+/** Write all samples which are currently queued for a destination */
+static void path_destination_drain(struct path *p, struct path_destination *pd)
+{
+	int cnt = pd->node->vectorize;
+	int available;
+
+	struct sample *smps[cnt];
+
+	/* As long as there are still samples in the queue */
+	while (1) {
+		available = queue_pull_many(&pd->queue.queue, (void **) smps, cnt);
+		if (available <= 0)
+			break;
+		else if (available < cnt)
+			debug(LOG_PATH | 5, "Queue underrun for path %s: available=%u expected=%u", path_name(p), available, cnt);
+
+		path_destination_write(p, pd, smps, available);
+	}
+}
+
+/** Account samples which have been dropped because the queue of a destination was full */
+static void path_destination_overrun(struct path *p, struct path_destination *pd, unsigned dropped)
+{
+	/* Reported by the statistics of the destination node (see stats_add_overruns()) */
+	atomic_fetch_add(&pd->overruns, dropped);
+
+	warn("Queue overrun for destination %s of path %s: dropped=%u", node_name(pd->node), path_name(p), dropped);
+}
+
+/** Push samples to the queue of a destination according to its overflow policy.
+ *
+ * @return The number of samples which have been enqueued.
+ */
+static unsigned path_destination_push(struct path *p, struct path_destination *pd, struct sample *smps[], unsigned cnt)
+{
+	unsigned enqueued;
+	int pushed, pulled;
+	struct timespec start, now;
+
+	pushed = queue_signalled_push_many(&pd->queue, (void **) smps, cnt);
+	if (pushed == cnt)
+		return cnt;
+
+	enqueued = pushed > 0 ? pushed : 0;
+
+	switch (pd->overflow) {
+		case PATH_OVERFLOW_DROP_OLDEST: {
+			struct sample *evicted[cnt];
+
+			/* Make room by evicting the oldest samples from the head of the queue */
+			while (enqueued < cnt) {
+				pulled = queue_pull_many(&pd->queue.queue, (void **) evicted, cnt - enqueued);
+				if (pulled > 0) {
+					sample_put_many(evicted, pulled);
+					path_destination_overrun(p, pd, pulled);
+				}
+
+				pushed = queue_signalled_push_many(&pd->queue, (void **) &smps[enqueued], cnt - enqueued);
+				if (pushed > 0)
+					enqueued += pushed;
+				else if (pulled <= 0)
+					break;
+			}
+			break;
+		}
+
+		case PATH_OVERFLOW_BLOCK:
+			clock_gettime(CLOCK_MONOTONIC, &start);
+
+			while (enqueued < cnt) {
+				/* Without a writer stage the path thread has to make room by itself */
+				if (p->pipeline)
+					sched_yield();
+				else
+					path_destination_drain(p, pd);
+
+				pushed = queue_signalled_push_many(&pd->queue, (void **) &smps[enqueued], cnt - enqueued);
+				if (pushed > 0)
+					enqueued += pushed;
+
+				clock_gettime(CLOCK_MONOTONIC, &now);
+				if (time_delta(&start, &now) > pd->overflow_timeout)
+					break;
+			}
+			break;
+
+		case PATH_OVERFLOW_DROP_NEWEST:
+			break;
+	}
+
+	if (enqueued < cnt)
+		path_destination_overrun(p, pd, cnt - enqueued);
+
+	return enqueued;
+}
+
+/** Pass samples to all destinations.
+ *
+ * The samples are not copied: every destination queue holds a reference to the same samples.
+ * Therefore they must not be modified anymore after they have been enqueued.
+ */
 static void path_destination_enqueue(struct path *p, struct sample *smps[], unsigned cnt)
 {
-	unsigned enqueued, cloned;
+	unsigned enqueued;
+
+	for (size_t i = 0; i < list_length(&p->destinations); i++) {
+		struct path_destination *pd = (struct path_destination *) list_at(&p->destinations, i);
+
+		/* Increase reference counter of these samples as they are now also owned by the queue.
+		 * This must happen before pushing, as a writer stage might release them immediately. */
+		sample_get_many(smps, cnt);
+
+		enqueued = path_destination_push(p, pd, smps, cnt);
+		if (enqueued != cnt)
+			sample_put_many(smps + enqueued, cnt - enqueued);
 
-	struct sample *clones[cnt];
+		debug(LOG_PATH | 15, "Enqueued %u samples to destination %s of path %s", enqueued, node_name(pd->node), path_name(p));
+	}
+}
 
-	cloned = sample_clone_many(clones, smps, cnt);
-	if (cloned < cnt)
+
+/** Re-enqueue the last sample */
+static void path_repeat(struct path *p)
+{
+	struct sample *smp;
+
+	/* The last sample might still be queued for the destinations: copy-on-write */
+	smp = sample_clone(p->last_sample);
+	if (!smp) {
 		warn("Pool underrun in path %s", path_name(p));
+		return;
+	}
+
+	smp->sequence = p->last_sequence++;
+
+	sample_put(p->last_sample);
+	p->last_sample = smp;
+
+	path_destination_enqueue(p, &p->last_sample, 1);
+}
+
+/** Timeout: re-enqueue the last sample */
+static void path_timeout(struct path *p)
+{
+	task_wait(&p->timeout);
+
+	path_repeat(p);
+}
+
+/** Multiplex samples which have been received by a source into the path */
+static void path_source_mux(struct path *p, int idx, struct sample *read_smps[], int recv)
+{
+	int tomux;
+
+	struct path_source *ps = (struct path_source *) list_at(&p->sources, idx);
+	struct sample *muxed_smps[recv];
+	struct sample **tomux_smps;
+
+	bitset_set(&p->received, idx);
+
+	if (p->mode == PATH_MODE_ANY) { /* Mux all samples */
+		tomux_smps = read_smps;
+		tomux = recv;
+	}
+	else { /* Mux only last sample and discard others */
+		tomux_smps = read_smps + recv - 1;
+		tomux = 1;
+	}
+
+	for (int i = 0; i < tomux; i++) {
+		muxed_smps[i] = i == 0
+			? sample_clone(p->last_sample)
+			: sample_clone(muxed_smps[i-1]);
+		if (!muxed_smps[i]) {
+			warn("Pool underrun in path %s", path_name(p));
+
+			tomux = i;
+			break;
+		}
+
+		muxed_smps[i]->sequence = p->last_sequence++;
+
+		mapping_plan_remap(&ps->plan, muxed_smps[i], tomux_smps[i]);
+	}
+
+	if (tomux == 0)
+		return;
+
+	/* Keep a reference instead of a copy. The muxed samples are immutable from now on. */
+	sample_put(p->last_sample);
+	p->last_sample = muxed_smps[tomux-1];
+	sample_get(p->last_sample);
+
+	info("received = %s", bitset_dump(&p->received));
+
+	if (bitset_test(&p->mask, idx)) {
+		/* Check if we received an update from all nodes/ */
+		if ((p->mode == PATH_MODE_ANY) ||
+		    (p->mode == PATH_MODE_ALL && !bitset_cmp(&p->mask, &p->received)))
+		{
+			path_destination_enqueue(p, muxed_smps, tomux);
+
+			/* Reset bitset of updated nodes */
+			bitset_clear_all(&p->received);
+		}
+	}
+
+	sample_put_many(muxed_smps, tomux);
+}
+
+/** A source is ready to receive samples */
+static void path_source_read(struct path *p, int idx)
+{
+	int recv, ready, cnt;
+
+	struct path_source *ps = (struct path_source *) list_at(&p->sources, idx);
+
+	cnt = ps->node->vectorize;
+
+	struct sample *read_smps[cnt];
+
+	/* Fill smps[] free sample blocks from the pool */
+	ready = sample_alloc_many(&ps->pool, read_smps, cnt);
+	if (ready != cnt)
+		warn("Pool underrun for path source %s", node_name(ps->node));
+
+	/* Read ready samples and store them to blocks pointed by smps[] */
+	recv = node_read(ps->node, read_smps, ready);
+	if (recv < 0)
+		error("Failed to read samples from node %s", node_name(ps->node));
+	else if (recv > 0) {
+		if (recv < ready)
+			warn("Partial read for path %s: read=%u, expected=%u", path_name(p), recv, ready);
+
+		path_source_mux(p, idx, read_smps, recv);
+	}
+
+	sample_put_many(read_smps, ready);
+}
+
+/** The reader stage of a pipelined path has passed samples to the processing stage */
+static void path_source_pull(struct path *p, int idx)
+{
+	int pulled, cnt;
+
+	struct path_source *ps = (struct path_source *) list_at(&p->sources, idx);
+
+	cnt = ps->node->vectorize;
+
+	struct sample *read_smps[cnt];
+
+	pulled = queue_signalled_pull_many_ready(&ps->queue, (void **) read_smps, cnt);
+	while (pulled > 0) {
+		path_source_mux(p, idx, read_smps, pulled);
+
+		sample_put_many(read_smps, pulled);
+
+		/* The notification has already been acknowledged: drain without blocking */
+		pulled = queue_pull_many(&ps->queue.queue, (void **) read_smps, cnt);
+	}
+}
+
+/** The file descriptor p->reader.pfds[idx] is readable */
+static void path_ready(struct path *p, int idx)
+{
+	if (p->rate > 0 && !p->polling && idx == p->reader.nfds - 1)
+		path_timeout(p);
+	else if (p->pipeline)
+		path_source_pull(p, idx);
+	else
+		path_source_read(p, idx);
+}
+
+/** Send all samples which have been queued for the destinations */
+static void path_flush(struct path *p)
+{
+	/* The writer stages of a pipelined path take care of the destinations */
+	if (p->pipeline)
+		return;
 
 	for (size_t i = 0; i < list_length(&p->destinations); i++) {
 		struct path_destination *pd = (struct path_destination *) list_at(&p->destinations, i);
 
-		enqueued = queue_push_many(&pd->queue, (void **) clones, cloned);
-		if (enqueued != cnt)
-			warn("Queue overrun for path %s", path_name(p));
+		path_destination_drain(p, pd);
+	}
+}
 
-		/* Increase reference counter of these samples as they are now also owned by the queue. */
-		sample_get_many(clones, cloned);
+/** Callback for paths which are run by a shared reactor */
+static void path_reactor_ready(void *ctx, int idx)
+{
+	struct path *p = ctx;
 
-		debug(LOG_PATH | 15, "Enqueued %u samples to destination %s of path %s", enqueued, node_name(pd->node), path_name(p));
+	path_ready(p, idx);
+	path_flush(p);
+}
+
+/** Handle an error condition of descriptor \p idx of path::reader which is not readable.
+ *
+ * @retval 0 The condition has been cleared by the source node.
+ * @retval <0 The condition persists.
+ */
+static int path_error(struct path *p, int idx)
+{
+	int timer = p->rate > 0 && !p->polling && idx == p->reader.nfds - 1;
+
+	/* The descriptors of pipelined paths belong to the reader stages */
+	if (!p->pipeline && !timer) {
+		struct path_source *ps = (struct path_source *) list_at(&p->sources, idx);
+
+		if (node_poll_error(ps->node) == 0)
+			return 0;
+
+		warn("Source node %s of path %s reported an error", node_name(ps->node), path_name(p));
+	}
+	else
+		warn("Descriptor %d of path %s reported an error", idx, path_name(p));
+
+	return -1;
+}
+
+/** Callback for error conditions which a shared reactor reports for a descriptor which is not readable */
+static void path_reactor_error(void *ctx, int idx)
+{
+	struct path *p = ctx;
+
+	/* The descriptor is registered edge-triggered: a persisting condition is not reported again */
+	path_error(p, idx);
+}
+
+/** Nothing to do for a busy-polling path */
+static void path_backoff(struct path *p)
+{
+	switch (p->backoff) {
+		case PATH_BACKOFF_PAUSE:
+#if defined(__x86_64__) || defined(__i386__)
+			__builtin_ia32_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+			__asm__ __volatile__ ("yield");
+#endif
+			break;
+
+		case PATH_BACKOFF_YIELD:
+			sched_yield();
+			break;
+
+		case PATH_BACKOFF_NONE:
+			break;
 	}
+}
 
-	sample_put_many(clones, cloned);
+/** Apply the scheduling settings of a node to the calling stage thread or fall back to those of the path */
+static void path_init_thread(struct path *p, struct node *n)
+{
+	if (n && (n->affinity || n->priority || n->deadline.runtime > 0))
+		rt_init_thread(n->priority, n->affinity, &n->deadline);
+	else
+		rt_init_thread(p->priority, p->affinity, &p->deadline);
+}
+
+/** Main thread function for busy-polling paths: spin over the sources without waiting in poll() */
+static void * path_run_polling(void *arg)
+{
+	int idle, avail;
+	struct path *p = arg;
+	struct timespec now, next, period;
+
+	path_init_thread(p, NULL);
+
+	if (p->rate > 0) {
+		period = time_from_double(1.0 / p->rate);
+
+		clock_gettime(CLOCK_MONOTONIC, &now);
+		next = time_add(&now, &period);
+	}
+
+	for (;;) {
+		/* Nothing in this loop blocks: path_stop() relies on an explicit cancellation point */
+		pthread_testcancel();
+
+		idle = 1;
+
+		for (int i = 0; i < list_length(&p->sources); i++) {
+			struct path_source *ps = (struct path_source *) list_at(&p->sources, i);
+
+			avail = p->pipeline
+				? queue_signalled_available(&ps->queue)
+				: node_available(ps->node);
+			if (avail <= 0)
+				continue;
+
+			if (p->pipeline)
+				path_source_pull(p, i);
+			else
+				path_source_read(p, i);
+
+			idle = 0;
+		}
+
+		/* The clock is read via the vDSO: this does not enter the kernel */
+		if (p->rate > 0) {
+			clock_gettime(CLOCK_MONOTONIC, &now);
+
+			if (time_delta(&next, &now) >= 0) {
+				path_repeat(p);
+
+				/* Skip missed periods instead of sending bursts */
+				while (time_delta(&next, &now) >= 0)
+					next = time_add(&next, &period);
+
+				idle = 0;
+			}
+		}
+
+		path_flush(p);
+
+		if (idle)
+			path_backoff(p);
+	}
+
+	return NULL;
 }
 
 /** Main thread function per path: read samples -> write samples */
 static void * path_run(void *arg)
 {
-	int ret, recv, tomux, ready, cnt;
+	int ret;
 	struct path *p = arg;
 
+	path_init_thread(p, NULL);
+
 	for (;;) {
 		ret = poll(p->reader.pfds, p->reader.nfds, -1);
 		if (ret < 0)
 			serror("Failed to poll");
 
 		for (int i = 0; i < p->reader.nfds; i++) {
-			struct path_source *ps = (struct path_source *) list_at(&p->sources, i);
+			short revents = p->reader.pfds[i].revents;
+
+			if (revents & POLLIN)
+				path_ready(p, i);
+			else if (revents & (POLLERR | POLLHUP)) {
+				/* poll() would report a persisting condition over and over again */
+				ret = path_error(p, i);
+				if (ret)
+					p->reader.pfds[i].fd = -1;
+			}
+		}
 
-			if (p->reader.pfds[i].revents & POLLIN) {
-				/* Timeout: re-enqueue the last sample */
-				if (p->reader.pfds[i].fd == task_fd(&p->timeout)) {
-					task_wait(&p->timeout);
+		path_flush(p);
+	}
 
-					p->last_sample->sequence = p->last_sequence++;
+	return NULL;
+}
 
-					path_destination_enqueue(p, &p->last_sample, 1);
-				}
-				/* A source is ready to receive samples */
-				else {
-					cnt = ps->node->vectorize;
-
-					struct sample *read_smps[cnt];
-					struct sample *muxed_smps[cnt];
-					struct sample **tomux_smps;
-
-					/* Fill smps[] free sample blocks from the pool */
-					ready = sample_alloc_many(&ps->pool, read_smps, cnt);
-					if (ready != cnt)
-						warn("Pool underrun for path source %s", node_name(ps->node));
-
-					/* Read ready samples and store them to blocks pointed by smps[] */
-					recv = node_read(ps->node, read_smps, ready);
-					if (recv == 0)
-						goto out2;
-					else if (recv < 0)
-						error("Failed to read samples from node %s", node_name(ps->node));
-					else if (recv < ready)
-						warn("Partial read for path %s: read=%u, expected=%u", path_name(p), recv, ready);
-
-					bitset_set(&p->received, i);
-
-					if (p->mode == PATH_MODE_ANY) { /* Mux all samples */
-						tomux_smps = read_smps;
-						tomux = recv;
-					}
-					else { /* Mux only last sample and discard others */
-						tomux_smps = read_smps + recv - 1;
-						tomux = 1;
-					}
-
-					for (int i = 0; i < tomux; i++) {
-						muxed_smps[i] = i == 0
-							? sample_clone(p->last_sample)
-							: sample_clone(muxed_smps[i-1]);
-
-						muxed_smps[i]->sequence = p->last_sequence++;
-
-						mapping_remap(&ps->mappings, muxed_smps[i], tomux_smps[i], NULL);
-					}
-
-					sample_copy(p->last_sample, muxed_smps[tomux-1]);
-
-					info("received = %s", bitset_dump(&p->received));
-
-					if (bitset_test(&p->mask, i)) {
-						/* Check if we received an update from all nodes/ */
-						if ((p->mode == PATH_MODE_ANY) ||
-						    (p->mode == PATH_MODE_ALL && !bitset_cmp(&p->mask, &p->received)))
-						{
-							path_destination_enqueue(p, muxed_smps, tomux);
-
-							/* Reset bitset of updated nodes */
-							bitset_clear_all(&p->received);
-						}
-					}
-
-					sample_put_many(muxed_smps, tomux);
-out2:					sample_put_many(read_smps, ready);
-				}
-			}
-		}
+/** Reader stage of a pipelined path: node -> processing stage */
+static void * path_run_source(void *arg)
+{
+	int recv, ready, enqueued, cnt;
+	struct path_source *ps = arg;
+	struct path *p = ps->path;
 
-		for (size_t i = 0; i < list_length(&p->destinations); i++) {
-			struct path_destination *pd = (struct path_destination *) list_at(&p->destinations, i);
+	/* Exponential backoff between 1 us and 1 ms while the pool is exhausted */
+	struct timespec delay = { .tv_sec = 0, .tv_nsec = 1000 };
 
-			int cnt = pd->node->vectorize;
-			int sent;
-			int available;
-			int released;
+	path_init_thread(p, ps->node);
 
-			struct sample *smps[cnt];
+	cnt = ps->node->vectorize;
 
-			/* As long as there are still samples in the queue */
-			while (1) {
-				available = queue_pull_many(&pd->queue, (void **) smps, cnt);
-				if (available == 0)
-					break;
-				else if (available < cnt)
-					debug(LOG_PATH | 5, "Queue underrun for path %s: available=%u expected=%u", path_name(p), available, cnt);
+	for (;;) {
+		struct sample *smps[cnt];
 
-				debug(LOG_PATH | 15, "Dequeued %u samples from queue of node %s which is part of path %s", available, node_name(pd->node), path_name(p));
+		ready = sample_alloc_many(&ps->pool, smps, cnt);
+		if (ready != cnt && delay.tv_nsec == 1000)
+			warn("Pool underrun for path source %s", node_name(ps->node));
 
-				sent = node_write(pd->node, smps, available);
-				if (sent < 0)
-					error("Failed to sent %u samples to node %s", cnt, node_name(pd->node));
-				else if (sent < available)
-					warn("Partial write to node %s: written=%d, expected=%d", node_name(pd->node), sent, available);
+		/* The processing stage is lagging behind. Give it some time to catch up. */
+		if (ready <= 0) {
+			nanosleep(&delay, NULL);
 
-				released = sample_put_many(smps, sent);
+			if (delay.tv_nsec < 1000000)
+				delay.tv_nsec *= 2;
 
-				debug(LOG_PATH | 15, "Released %d samples back to memory pool", released);
-			}
+			continue;
 		}
+
+		delay.tv_nsec = 1000;
+
+		recv = node_read(ps->node, smps, ready);
+		if (recv < 0)
+			error("Failed to read samples from node %s", node_name(ps->node));
+		else if (recv < ready)
+			sample_put_many(&smps[recv], ready - recv);
+
+		/* Do not wake up the processing stage without samples */
+		if (recv == 0)
+			continue;
+
+		enqueued = queue_signalled_push_many(&ps->queue, (void **) smps, recv);
+		if (enqueued < 0)
+			break;
+		else if (enqueued < recv) {
+			warn("Queue overrun for source %s of path %s", node_name(ps->node), path_name(p));
+
+			sample_put_many(&smps[enqueued], recv - enqueued);
+		}
+	}
+
+	return NULL;
+}
+
+/** Writer stage of a pipelined path: processing stage -> node */
+static void * path_run_destination(void *arg)
+{
+	int pulled, cnt;
+	struct path_destination *pd = arg;
+	struct path *p = pd->path;
+
+	path_init_thread(p, pd->node);
+
+	cnt = pd->node->vectorize;
+
+	for (;;) {
+		struct sample *smps[cnt];
+
+		pulled = queue_signalled_pull_many(&pd->queue, (void **) smps, cnt);
+		if (pulled < 0)
+			break;
+
+		path_destination_write(p, pd, smps, pulled);
 	}
 
 	return NULL;
@@ -255,7 +740,18 @@ int path_init(struct path *p)
 
 	p->reverse = 0;
 	p->enabled = 1;
+	p->pipeline = 0;
+	p->polling = 0;
+	p->backoff = PATH_BACKOFF_PAUSE;
+	p->affinity = 0;
+	p->priority = 0;
+	p->deadline.runtime = 0;
+	p->numa_node = -1;
+	p->reactor = NULL;
+	p->last_sample = NULL;
 	p->queuelen = DEFAULT_QUEUELEN;
+	p->pool_cache = 0;
+	p->occupancy = 0;
 
 	/* Add internal hooks if they are not already in the list */
 	for (size_t i = 0; i < list_length(&plugins); i++) {
@@ -295,7 +791,7 @@ int path_init2(struct path *p)
 	for (size_t i = 0; i < list_length(&p->destinations); i++) {
 		struct path_destination *pd = (struct path_destination *) list_at(&p->destinations, i);
 
-		ret = path_destination_init(pd, p->queuelen);
+		ret = path_destination_init(pd, p);
 		if (ret)
 			return ret;
 	}
@@ -304,7 +800,7 @@ int path_init2(struct path *p)
 	for (size_t i = 0; i < list_length(&p->sources); i++) {
 		struct path_source *ps = (struct path_source *) list_at(&p->sources, i);
 
-		ret = path_source_init(ps);
+		ret = path_source_init(ps, p);
 		if (ret)
 			return ret;
 	}
@@ -312,40 +808,34 @@ int path_init2(struct path *p)
 	bitset_init(&p->received, list_length(&p->sources));
 	bitset_init(&p->mask, list_length(&p->sources));
 
-	/* Calc sample length of path and initialize bitset */
-	p->samplelen = 0;
+	/* Initialize bitset */
 	for (size_t i = 0; i < list_length(&p->sources); i++) {
 		struct path_source *ps = (struct path_source *) list_at(&p->sources, i);
 
 		if (ps->masked)
 			bitset_set(&p->mask, i);
-
-		for (size_t i = 0; i < list_length(&ps->mappings); i++) {
-			struct mapping_entry *me = (struct mapping_entry *) list_at(&ps->mappings, i);
-
-			int len = me->length;
-			int off = me->offset;
-
-			if (off + len > p->samplelen)
-				p->samplelen = off + len;
-		}
 	}
 
-	if (!p->samplelen)
-		p->samplelen = DEFAULT_SAMPLELEN;
+	ret = pool_init(&p->pool, MAX(1, list_length(&p->destinations)) * p->queuelen + path_pool_reserve(p), SAMPLE_LEN(p->samplelen), memtype_numa(p->numa_node));
+	if (ret)
+		return ret;
 
-	ret = pool_init(&p->pool, MAX(1, list_length(&p->destinations)) * p->queuelen, SAMPLE_LEN(p->samplelen), &memtype_hugepage);
+	ret = pool_cache_init(&p->pool, p->pool_cache);
 	if (ret)
 		return ret;
 
+	if (p->occupancy)
+		pool_occupancy_enable(&p->pool);
+
 	p->last_sample = sample_alloc(&p->pool);
 	if (!p->last_sample)
 		return -1;
 
-	/* Prepare poll() */
+	/* Prepare poll(): pipelined paths wait for their reader stages instead of the nodes */
 	int nfds = list_length(&p->sources);
 
-	if (p->rate > 0)
+	/* Busy-polling paths keep the rate with clock_gettime() and do not need a timer */
+	if (p->rate > 0 && !p->polling)
 		nfds++;
 
 	p->reader.nfds = nfds;
@@ -354,13 +844,22 @@ int path_init2(struct path *p)
 	for (int i = 0; i < list_length(&p->sources); i++) {
 		struct path_source *ps = (struct path_source *) list_at(&p->sources, i);
 
+		if (p->polling && !p->pipeline && !ps->node->_vt->available && !ps->node->_vt->fd)
+			error("Node %s can not be used as a source of busy-polling path %s", node_name(ps->node), path_name(p));
+
+		/* E.g. shmem nodes or loopback nodes with the adaptive wait strategy */
+		if (!p->polling && !p->pipeline && node_fd(ps->node) < 0)
+			error("Node %s has no file descriptor. Enable 'pipeline' or 'polling' for path %s", node_name(ps->node), path_name(p));
+
 		/* This slot is only used if it is not masked */
 		p->reader.pfds[i].events = POLLIN;
-		p->reader.pfds[i].fd = node_fd(ps->node);
+		p->reader.pfds[i].fd = p->pipeline
+			? queue_signalled_fd(&ps->queue)
+			: node_fd(ps->node);
 	}
 
 	/* We use the last slot for the timeout timer. */
-	if (p->rate > 0) {
+	if (p->rate > 0 && !p->polling) {
 		ret = task_init(&p->timeout, p->rate, CLOCK_MONOTONIC);
 		if (ret)
 			return ret;
@@ -372,17 +871,84 @@ int path_init2(struct path *p)
 	return 0;
 }
 
+static int path_lookup_overflow(const char *str)
+{
+	if      (!strcmp(str, "drop-newest"))
+		return PATH_OVERFLOW_DROP_NEWEST;
+	else if (!strcmp(str, "drop-oldest"))
+		return PATH_OVERFLOW_DROP_OLDEST;
+	else if (!strcmp(str, "block"))
+		return PATH_OVERFLOW_BLOCK;
+	else
+		return -1;
+}
+
+/** Parse the 'overflow' setting: either a single policy for all destinations or an object with a policy per destination node */
+static int path_parse_overflow(struct path *p, json_t *cfg)
+{
+	int policy;
+	const char *str, *name;
+	json_t *json_policy;
+
+	if (json_is_string(cfg)) {
+		policy = path_lookup_overflow(json_string_value(cfg));
+		if (policy < 0)
+			error("Invalid overflow policy '%s' for path %s", json_string_value(cfg), path_name(p));
+
+		for (size_t i = 0; i < list_length(&p->destinations); i++) {
+			struct path_destination *pd = (struct path_destination *) list_at(&p->destinations, i);
+
+			pd->overflow = policy;
+		}
+	}
+	else if (json_is_object(cfg)) {
+		json_object_foreach(cfg, name, json_policy) {
+			struct path_destination *pd = NULL;
+
+			for (size_t i = 0; i < list_length(&p->destinations); i++) {
+				struct path_destination *pt = (struct path_destination *) list_at(&p->destinations, i);
+
+				if (!strcmp(pt->node->name, name)) {
+					pd = pt;
+					break;
+				}
+			}
+
+			if (!pd)
+				error("Node %s is not a destination of the path %s", name, path_name(p));
+
+			str = json_string_value(json_policy);
+			if (!str)
+				error("The overflow policy for destination %s of path %s must be a string", name, path_name(p));
+
+			policy = path_lookup_overflow(str);
+			if (policy < 0)
+				error("Invalid overflow policy '%s' for destination %s of path %s", str, name, path_name(p));
+
+			pd->overflow = policy;
+		}
+	}
+	else
+		error("The 'overflow' setting of path %s must be a string or an object", path_name(p));
+
+	return 0;
+}
+
 int path_parse(struct path *p, json_t *cfg, struct list *nodes)
 {
 	int ret;
+	double overflow_timeout = 1.0;
 
 	json_error_t err;
 	json_t *json_in;
 	json_t *json_out = NULL;
 	json_t *json_hooks = NULL;
 	json_t *json_mask = NULL;
+	json_t *json_deadline = NULL;
+	json_t *json_overflow = NULL;
 
 	const char *mode = NULL;
+	const char *backoff = NULL;
 
 	struct list sources = { .state = STATE_DESTROYED };
 	struct list destinations = { .state = STATE_DESTROYED };
@@ -390,13 +956,24 @@ int path_parse(struct path *p, json_t *cfg, struct list *nodes)
 	list_init(&sources);
 	list_init(&destinations);
 
-	ret = json_unpack_ex(cfg, &err, 0, "{ s: o, s?: o, s?: o, s?: b, s?: b, s?: i, s?: s, s?: F, s?: o }",
+	ret = json_unpack_ex(cfg, &err, 0, "{ s: o, s?: o, s?: o, s?: b, s?: b, s?: b, s?: b, s?: s, s?: i, s?: i, s?: o, s?: o, s?: F, s?: i, s?: i, s?: b, s?: i, s?: s, s?: F, s?: o }",
 		"in", &json_in,
 		"out", &json_out,
 		"hooks", &json_hooks,
 		"reverse", &p->reverse,
 		"enabled", &p->enabled,
+		"pipeline", &p->pipeline,
+		"polling", &p->polling,
+		"backoff", &backoff,
+		"affinity", &p->affinity,
+		"priority", &p->priority,
+		"deadline", &json_deadline,
+		"overflow", &json_overflow,
+		"overflow_timeout", &overflow_timeout,
 		"queuelen", &p->queuelen,
+		"pool_cache", &p->pool_cache,
+		"occupancy", &p->occupancy,
+		"numa_node", &p->numa_node,
 		"mode", &mode,
 		"rate", &p->rate,
 		"mask", &json_mask
@@ -419,6 +996,23 @@ int path_parse(struct path *p, json_t *cfg, struct list *nodes)
 			error("Invalid path mode '%s'", mode);
 	}
 
+	if (json_deadline) {
+		ret = rt_parse_deadline(&p->deadline, json_deadline);
+		if (ret)
+			error("Failed to parse deadline settings of path %s", path_name(p));
+	}
+
+	if (backoff) {
+		if      (!strcmp(backoff, "none"))
+			p->backoff = PATH_BACKOFF_NONE;
+		else if (!strcmp(backoff, "pause"))
+			p->backoff = PATH_BACKOFF_PAUSE;
+		else if (!strcmp(backoff, "yield"))
+			p->backoff = PATH_BACKOFF_YIELD;
+		else
+			error("Invalid backoff strategy '%s' for path %s", backoff, path_name(p));
+	}
+
 	/* Output node(s) */
 	if (json_out) {
 		ret = node_parse_list(&destinations, json_out, nodes);
@@ -463,10 +1057,18 @@ int path_parse(struct path *p, json_t *cfg, struct list *nodes)
 		struct path_destination *pd = (struct path_destination *) alloc(sizeof(struct path_destination));
 
 		pd->node = n;
+		pd->overflow = PATH_OVERFLOW_DROP_NEWEST;
+		pd->overflow_timeout = overflow_timeout;
 
 		list_push(&p->destinations, pd);
 	}
 
+	if (json_overflow) {
+		ret = path_parse_overflow(p, json_overflow);
+		if (ret)
+			error("Failed to parse overflow policy of path %s", path_name(p));
+	}
+
 	if (json_mask) {
 		json_t *json_entry;
 		size_t i;
@@ -533,6 +1135,9 @@ int path_check(struct path *p)
 	if (p->rate < 0)
 		error("Setting 'rate' of path %s must be a positive number.", path_name(p));
 
+	if (p->pool_cache < 0)
+		error("Setting 'pool_cache' of path %s must not be negative.", path_name(p));
+
 	for (size_t i = 0; i < list_length(&p->sources); i++) {
 		struct path_source *ps = (struct path_source *) list_at(&p->sources, i);
 
@@ -547,16 +1152,76 @@ int path_check(struct path *p)
 			error("Destiation node '%s' is not supported as a sink for path '%s'", node_name(pd->node), path_name(p));
 	}
 
+#ifndef __linux__
+	if (p->pipeline)
+		error("Pipelined paths are only supported on Linux. Please disable setting 'pipeline' of path %s", path_name(p));
+#endif
+
 	if (!IS_POW2(p->queuelen)) {
 		p->queuelen = LOG2_CEIL(p->queuelen);
 		warn("Queue length should always be a power of 2. Adjusting to %d", p->queuelen);
 	}
 
+	/* Calc sample length of path */
+	p->samplelen = 0;
+	for (size_t i = 0; i < list_length(&p->sources); i++) {
+		struct path_source *ps = (struct path_source *) list_at(&p->sources, i);
+
+		for (size_t i = 0; i < list_length(&ps->mappings); i++) {
+			struct mapping_entry *me = (struct mapping_entry *) list_at(&ps->mappings, i);
+
+			int len = me->length;
+			int off = me->offset;
+
+			if (off + len > p->samplelen)
+				p->samplelen = off + len;
+		}
+	}
+
+	if (!p->samplelen)
+		p->samplelen = DEFAULT_SAMPLELEN;
+
+	/* Place pools and queues next to the first CPU the path is pinned to */
+	if (p->numa_node < 0 && p->affinity)
+		p->numa_node = kernel_get_cpu_numa_node(ffs(p->affinity) - 1);
+
 	p->state = STATE_CHECKED;
 
 	return 0;
 }
 
+size_t path_footprint(struct path *p)
+{
+	size_t len = 0;
+
+	assert(p->state == STATE_CHECKED);
+
+	/* Buffers which are placed on a NUMA node are not allocated from the arena */
+	for (size_t i = 0; i < list_length(&p->sources); i++) {
+		struct path_source *ps = (struct path_source *) list_at(&p->sources, i);
+
+		if (path_memtype(p, ps->node) != &memtype_hugepage)
+			continue;
+
+		len += pool_footprint(MAX(DEFAULT_QUEUELEN, ps->node->vectorize) + path_pool_reserve(p), SAMPLE_LEN(ps->node->samplelen), p->pool_cache);
+
+		if (p->pipeline)
+			len += queue_footprint(p->queuelen);
+	}
+
+	for (size_t i = 0; i < list_length(&p->destinations); i++) {
+		struct path_destination *pd = (struct path_destination *) list_at(&p->destinations, i);
+
+		if (path_memtype(p, pd->node) == &memtype_hugepage)
+			len += queue_footprint(p->queuelen);
+	}
+
+	if (memtype_numa(p->numa_node) == &memtype_hugepage)
+		len += pool_footprint(MAX(1, list_length(&p->destinations)) * p->queuelen + path_pool_reserve(p), SAMPLE_LEN(p->samplelen), p->pool_cache);
+
+	return len;
+}
+
 int path_start(struct path *p)
 {
 	int ret;
@@ -572,14 +1237,16 @@ int path_start(struct path *p)
 
 	mask = bitset_dump(&p->mask);
 
-	info("Starting path %s: mode=%s, mask=%s, rate=%.2f, enabled=%s, reversed=%s, queuelen=%d, samplelen=%d, #hooks=%zu, #sources=%zu, #destinations=%zu",
+	info("Starting path %s: mode=%s, mask=%s, rate=%.2f, enabled=%s, reversed=%s, pipeline=%s, polling=%s, queuelen=%d, samplelen=%d, numa_node=%d, #hooks=%zu, #sources=%zu, #destinations=%zu",
 		path_name(p),
 		mode,
 		mask,
 		p->rate,
 		p->enabled ? "yes": "no",
 		p->reverse ? "yes": "no",
-		p->queuelen, p->samplelen,
+		p->pipeline ? "yes": "no",
+		p->polling ? "yes": "no",
+		p->queuelen, p->samplelen, p->numa_node,
 		list_length(&p->hooks),
 		list_length(&p->sources),
 		list_length(&p->destinations)
@@ -595,6 +1262,35 @@ int path_start(struct path *p)
 			return ret;
 	}
 
+	/* Report the fill levels of the pools and queues of this path as part of the node statistics */
+	if (p->occupancy) {
+		for (size_t i = 0; i < list_length(&p->sources); i++) {
+			struct path_source *ps = (struct path_source *) list_at(&p->sources, i);
+
+			if (!ps->node->stats)
+				continue;
+
+			stats_add_pool(ps->node->stats, &ps->pool);
+
+			if (p->pipeline)
+				stats_add_queue(ps->node->stats, &ps->queue.queue);
+		}
+
+		for (size_t i = 0; i < list_length(&p->destinations); i++) {
+			struct path_destination *pd = (struct path_destination *) list_at(&p->destinations, i);
+
+			if (pd->node->stats)
+				stats_add_queue(pd->node->stats, &pd->queue.queue);
+		}
+	}
+
+	for (size_t i = 0; i < list_length(&p->destinations); i++) {
+		struct path_destination *pd = (struct path_destination *) list_at(&p->destinations, i);
+
+		if (pd->node->stats)
+			stats_add_overruns(pd->node->stats, &pd->overruns);
+	}
+
 	p->last_sequence = 0;
 
 	bitset_clear_all(&p->received);
@@ -620,10 +1316,40 @@ int path_start(struct path *p)
 		}
 	}
 
-	/* Start one thread per path for sending to destinations */
-	ret = pthread_create(&p->tid, NULL, &path_run, p);
-	if (ret)
-		return ret;
+	if (p->reactor) {
+		/* All descriptors of a path are handled by the same worker */
+		p->worker = reactor_assign(p->reactor);
+
+		for (int i = 0; i < p->reader.nfds; i++) {
+			ret = reactor_add(p->reactor, p->worker, p->reader.pfds[i].fd, path_reactor_ready, path_reactor_error, p, i);
+			if (ret)
+				return ret;
+		}
+	}
+	else {
+		/* Start one thread per path for sending to destinations */
+		ret = pthread_create(&p->tid, NULL, p->polling ? &path_run_polling : &path_run, p);
+		if (ret)
+			return ret;
+	}
+
+	if (p->pipeline) {
+		for (size_t i = 0; i < list_length(&p->sources); i++) {
+			struct path_source *ps = (struct path_source *) list_at(&p->sources, i);
+
+			ret = pthread_create(&ps->tid, NULL, &path_run_source, ps);
+			if (ret)
+				return ret;
+		}
+
+		for (size_t i = 0; i < list_length(&p->destinations); i++) {
+			struct path_destination *pd = (struct path_destination *) list_at(&p->destinations, i);
+
+			ret = pthread_create(&pd->tid, NULL, &path_run_destination, pd);
+			if (ret)
+				return ret;
+		}
+	}
 
 	p->state = STATE_STARTED;
 
@@ -639,13 +1365,46 @@ int path_stop(struct path *p)
 
 	info("Stopping path: %s", path_name(p));
 
-	ret = pthread_cancel(p->tid);
-	if (ret)
-		return ret;
+	if (p->reactor) {
+		ret = reactor_remove(p->reactor, p);
+		if (ret)
+			return ret;
+	}
+	else {
+		ret = pthread_cancel(p->tid);
+		if (ret)
+			return ret;
 
-	ret = pthread_join(p->tid, NULL);
-	if (ret)
-		return ret;
+		ret = pthread_join(p->tid, NULL);
+		if (ret)
+			return ret;
+	}
+
+	if (p->pipeline) {
+		for (size_t i = 0; i < list_length(&p->sources); i++) {
+			struct path_source *ps = (struct path_source *) list_at(&p->sources, i);
+
+			ret = pthread_cancel(ps->tid);
+			if (ret)
+				return ret;
+
+			ret = pthread_join(ps->tid, NULL);
+			if (ret)
+				return ret;
+		}
+
+		for (size_t i = 0; i < list_length(&p->destinations); i++) {
+			struct path_destination *pd = (struct path_destination *) list_at(&p->destinations, i);
+
+			ret = pthread_cancel(pd->tid);
+			if (ret)
+				return ret;
+
+			ret = pthread_join(pd->tid, NULL);
+			if (ret)
+				return ret;
+		}
+	}
 
 	for (size_t i = 0; i < list_length(&p->hooks); i++) {
 		struct hook *h = (struct hook *) list_at(&p->hooks, i);
@@ -655,6 +1414,61 @@ int path_stop(struct path *p)
 			return ret;
 	}
 
+	if (p->occupancy) {
+		struct queue_occupancy o;
+
+		pool_occupancy(&p->pool, &o);
+		info("Occupancy of path %s: pool highwater=%zu/%zu, failures=%zu", path_name(p), o.highwater, o.capacity, o.failures);
+
+		for (size_t i = 0; i < list_length(&p->sources); i++) {
+			struct path_source *ps = (struct path_source *) list_at(&p->sources, i);
+
+			pool_occupancy(&ps->pool, &o);
+			info("Occupancy of source %s: pool highwater=%zu/%zu, failures=%zu", node_name(ps->node), o.highwater, o.capacity, o.failures);
+
+			if (ps->node->stats) {
+				stats_remove(ps->node->stats, &ps->pool);
+				stats_remove(ps->node->stats, &ps->queue.queue);
+			}
+		}
+
+		for (size_t i = 0; i < list_length(&p->destinations); i++) {
+			struct path_destination *pd = (struct path_destination *) list_at(&p->destinations, i);
+
+			queue_occupancy(&pd->queue.queue, &o);
+			info("Occupancy of destination %s: queue highwater=%zu/%zu, failures=%zu", node_name(pd->node), o.highwater, o.capacity, o.failures);
+
+			if (pd->node->stats)
+				stats_remove(pd->node->stats, &pd->queue.queue);
+		}
+	}
+
+	for (size_t i = 0; i < list_length(&p->destinations); i++) {
+		struct path_destination *pd = (struct path_destination *) list_at(&p->destinations, i);
+
+		if (pd->node->stats)
+			stats_remove(pd->node->stats, &pd->overruns);
+	}
+
+	if (p->pool_cache) {
+		uint64_t hits, misses;
+
+		pool_cache_stats(&p->pool, &hits, &misses);
+
+		for (size_t i = 0; i < list_length(&p->sources); i++) {
+			struct path_source *ps = (struct path_source *) list_at(&p->sources, i);
+			uint64_t h, m;
+
+			pool_cache_stats(&ps->pool, &h, &m);
+
+			hits += h;
+			misses += m;
+		}
+
+		info("Pool cache of path %s: hits=%ju, misses=%ju, hit rate=%.1f%%", path_name(p),
+			(uintmax_t) hits, (uintmax_t) misses, hits + misses ? 100.0 * hits / (hits + misses) : 0.0);
+	}
+
 	p->state = STATE_STOPPED;
 
 	return 0;
@@ -675,9 +1489,12 @@ int path_destroy(struct path *p)
 	if (p->_name)
 		free(p->_name);
 
-	if (p->rate > 0)
+	if (p->rate > 0 && !p->polling)
 		task_destroy(&p->timeout);
 
+	if (p->last_sample)
+		sample_put(p->last_sample);
+
 	pool_destroy(&p->pool);
 
 	p->state = STATE_DESTROYED;
@@ -20,6 +20,10 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  *********************************************************************************/
 
+#include <pthread.h>
+#include <string.h>
+
+#include "config.h"
 #include "utils.h"
 
 #include "pool.h"
@@ -27,16 +31,27 @@
 #include "kernel/kernel.h"
 
 int pool_init(struct pool *p, size_t cnt, size_t blocksz, struct memtype *m)
+{
+	return pool_init_aligned(p, cnt, blocksz, 0, m);
+}
+
+int pool_init_aligned(struct pool *p, size_t cnt, size_t blocksz, size_t alignment, struct memtype *m)
 {
 	int ret;
 
 	assert(p->state == STATE_DESTROYED);
 
-	/* Make sure that we use a block size that is aligned to the size of a cache line */
-	p->alignment = kernel_get_cacheline_size();
+	/* Make sure that we use a block size that is aligned to at least the size of a cache line */
+	p->alignment = MAX(alignment, (size_t) kernel_get_cacheline_size());
 	p->blocksz = p->alignment * CEIL(blocksz, p->alignment);
 	p->len = cnt * p->blocksz;
 	p->mem = m;
+	p->cache_size = 0;
+	p->occupancy = 0;
+
+	atomic_store(&p->used, 0);
+	atomic_store(&p->highwater, 0);
+	atomic_store(&p->failures, 0);
 
 	void *buffer = memory_alloc_aligned(m, p->len, p->alignment);
 	if (!buffer)
@@ -45,7 +60,7 @@ int pool_init(struct pool *p, size_t cnt, size_t blocksz, struct memtype *m)
 		debug(LOG_POOL | 4, "Allocated %#zx bytes for memory pool", p->len);
 	p->buffer_off = (char*) buffer - (char*) p;
 
-	ret = queue_init(&p->queue, LOG2_CEIL(cnt), m);
+	ret = queue_init(&p->queue, LOG2_CEIL(cnt), m, QUEUE_MPMC);
 	if (ret)
 		return ret;
 
@@ -57,6 +72,26 @@ int pool_init(struct pool *p, size_t cnt, size_t blocksz, struct memtype *m)
 	return 0;
 }
 
+size_t pool_footprint(size_t cnt, size_t blocksz, size_t cache)
+{
+	return pool_footprint_aligned(cnt, blocksz, 0, cache);
+}
+
+size_t pool_footprint_aligned(size_t cnt, size_t blocksz, size_t alignment, size_t cache)
+{
+	size_t len, cacheline = kernel_get_cacheline_size();
+
+	alignment = MAX(alignment, cacheline);
+
+	len  = memory_footprint(cnt * alignment * CEIL(blocksz, alignment), alignment);
+	len += queue_footprint(LOG2_CEIL(cnt));
+
+	if (cache > 0)
+		len += memory_footprint(POOL_CACHE_SLOTS * cacheline * CEIL(sizeof(struct pool_cache) + cache * sizeof(void *), cacheline), cacheline);
+
+	return len;
+}
+
 int pool_destroy(struct pool *p)
 {
 	int ret;
@@ -66,6 +101,16 @@ int pool_destroy(struct pool *p)
 
 	queue_destroy(&p->queue);
 
+	if (p->cache_size) {
+		void *caches = (char *) p + p->cache_off;
+
+		ret = memory_free(p->mem, caches, POOL_CACHE_SLOTS * p->cache_stride);
+		if (ret)
+			return ret;
+
+		p->cache_size = 0;
+	}
+
 	void *buffer = (char*) p + p->buffer_off;
 	ret = memory_free(p->mem, buffer, p->len);
 	if (ret == 0)
@@ -73,3 +118,219 @@ int pool_destroy(struct pool *p)
 
 	return ret;
 }
+
+void pool_occupancy_enable(struct pool *p)
+{
+	p->occupancy = 1;
+}
+
+void pool_occupancy(struct pool *p, struct queue_occupancy *o)
+{
+	o->capacity = p->len / p->blocksz;
+	o->fill = atomic_load_explicit(&p->used, memory_order_relaxed);
+	o->highwater = atomic_load_explicit(&p->highwater, memory_order_relaxed);
+	o->failures = atomic_load_explicit(&p->failures, memory_order_relaxed);
+}
+
+void pool_occupancy_put(struct pool *p, size_t cnt)
+{
+	atomic_fetch_sub_explicit(&p->used, cnt, memory_order_relaxed);
+}
+
+void pool_occupancy_get(struct pool *p, size_t got, size_t cnt)
+{
+	size_t used, highwater;
+
+	if (got < cnt)
+		atomic_fetch_add_explicit(&p->failures, cnt - got, memory_order_relaxed);
+
+	used = atomic_fetch_add_explicit(&p->used, got, memory_order_relaxed) + got;
+	highwater = atomic_load_explicit(&p->highwater, memory_order_relaxed);
+
+	while (used > highwater && !atomic_compare_exchange_weak_explicit(&p->highwater, &highwater, used, memory_order_relaxed, memory_order_relaxed));
+}
+
+/* Each thread which uses a pool cache gets one of POOL_CACHE_SLOTS slots.
+ * The slot selects the magazine of the thread in every pool.
+ * Slots of terminated threads are recycled together with the blocks in their magazines. */
+static pthread_once_t pool_cache_once = PTHREAD_ONCE_INIT;
+static pthread_key_t pool_cache_key;
+static pthread_mutex_t pool_cache_mutex = PTHREAD_MUTEX_INITIALIZER;
+static char pool_cache_used[POOL_CACHE_SLOTS];
+
+static __thread int pool_cache_slot = -1;
+
+static void pool_cache_release_slot(void *arg)
+{
+	int slot = (intptr_t) arg - 1;
+
+	pthread_mutex_lock(&pool_cache_mutex);
+	pool_cache_used[slot] = 0;
+	pthread_mutex_unlock(&pool_cache_mutex);
+}
+
+static void pool_cache_create_key()
+{
+	pthread_key_create(&pool_cache_key, pool_cache_release_slot);
+}
+
+static struct pool_cache * pool_cache_local(struct pool *p)
+{
+	if (pool_cache_slot < 0) {
+		pthread_once(&pool_cache_once, pool_cache_create_key);
+
+		pthread_mutex_lock(&pool_cache_mutex);
+
+		for (int i = 0; i < POOL_CACHE_SLOTS; i++) {
+			if (!pool_cache_used[i]) {
+				pool_cache_used[i] = 1;
+				pool_cache_slot = i;
+				break;
+			}
+		}
+
+		pthread_mutex_unlock(&pool_cache_mutex);
+
+		/* All slots are taken: this thread bypasses the caches */
+		if (pool_cache_slot < 0) {
+			pool_cache_slot = POOL_CACHE_SLOTS;
+			return NULL;
+		}
+
+		pthread_setspecific(pool_cache_key, (void *) (intptr_t) (pool_cache_slot + 1));
+
+		debug(LOG_POOL | 10, "Assigned pool cache slot %d to thread", pool_cache_slot);
+	}
+
+	if (pool_cache_slot >= POOL_CACHE_SLOTS)
+		return NULL;
+
+	return (struct pool_cache *) ((char *) p + p->cache_off + pool_cache_slot * p->cache_stride);
+}
+
+int pool_cache_init(struct pool *p, size_t size)
+{
+	assert(p->state == STATE_INITIALIZED);
+	assert(p->cache_size == 0);
+
+	if (size == 0)
+		return 0;
+
+	size_t alignment = kernel_get_cacheline_size();
+	size_t stride = alignment * CEIL(sizeof(struct pool_cache) + size * sizeof(void *), alignment);
+
+	void *caches = memory_alloc_aligned(p->mem, POOL_CACHE_SLOTS * stride, alignment);
+	if (!caches)
+		return -1;
+
+	for (int i = 0; i < POOL_CACHE_SLOTS; i++) {
+		struct pool_cache *c = (struct pool_cache *) ((char *) caches + i * stride);
+
+		c->count = 0;
+		c->hits = 0;
+		c->misses = 0;
+	}
+
+	p->cache_off = (char *) caches - (char *) p;
+	p->cache_stride = stride;
+	p->cache_size = size;
+
+	debug(LOG_POOL | 4, "Enabled pool cache with %zu blocks per thread", size);
+
+	return 0;
+}
+
+void pool_cache_stats(struct pool *p, uint64_t *hits, uint64_t *misses)
+{
+	*hits = 0;
+	*misses = 0;
+
+	if (!p->cache_size)
+		return;
+
+	/* The counters are owned by other threads: we accept slightly outdated values */
+	for (int i = 0; i < POOL_CACHE_SLOTS; i++) {
+		struct pool_cache *c = (struct pool_cache *) ((char *) p + p->cache_off + i * p->cache_stride);
+
+		*hits += c->hits;
+		*misses += c->misses;
+	}
+}
+
+ssize_t pool_cache_get_many(struct pool *p, void *blocks[], size_t cnt)
+{
+	ssize_t ret;
+	struct pool_cache *c = pool_cache_local(p);
+
+	if (!c)
+		return queue_pull_many(&p->queue, blocks, cnt);
+
+	if (c->count >= cnt)
+		c->hits++;
+	else {
+		c->misses++;
+
+		/* Large requests drain the magazine and take the rest directly from the queue */
+		if (cnt > p->cache_size) {
+			size_t avail = c->count;
+
+			for (size_t i = 0; i < avail; i++)
+				blocks[i] = c->blocks[--c->count];
+
+			ret = queue_pull_many(&p->queue, &blocks[avail], cnt - avail);
+
+			return ret > 0 ? avail + ret : avail;
+		}
+
+		/* Refill with enough blocks for this request and half a magazine more */
+		size_t want = MIN(p->cache_size, cnt + p->cache_size / 2) - c->count;
+
+		ret = queue_pull_many(&p->queue, &c->blocks[c->count], want);
+		if (ret > 0)
+			c->count += ret;
+	}
+
+	size_t avail = MIN(cnt, c->count);
+
+	for (size_t i = 0; i < avail; i++)
+		blocks[i] = c->blocks[--c->count];
+
+	return avail;
+}
+
+ssize_t pool_cache_put_many(struct pool *p, void *blocks[], size_t cnt)
+{
+	ssize_t ret;
+	struct pool_cache *c = pool_cache_local(p);
+
+	if (!c || cnt > p->cache_size)
+		return queue_push_many(&p->queue, blocks, cnt);
+
+	if (c->count + cnt > p->cache_size) {
+		/* Flush the coldest blocks from the bottom of the stack until the magazine is half full again */
+		size_t flush = MIN(c->count, c->count + cnt - p->cache_size / 2);
+
+		ret = queue_push_many(&p->queue, c->blocks, flush);
+		if (ret > 0) {
+			memmove(c->blocks, &c->blocks[ret], (c->count - ret) * sizeof(void *));
+			c->count -= ret;
+		}
+
+		c->misses++;
+	}
+	else
+		c->hits++;
+
+	size_t room = MIN(cnt, p->cache_size - c->count);
+
+	for (size_t i = 0; i < room; i++)
+		c->blocks[c->count++] = blocks[i];
+
+	if (room < cnt) {
+		ret = queue_push_many(&p->queue, &blocks[room], cnt - room);
+		if (ret > 0)
+			room += ret;
+	}
+
+	return room;
+}
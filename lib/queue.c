@@ -36,7 +36,7 @@
 #include "memory.h"
 
 /** Initialize MPMC queue */
-int queue_init(struct queue *q, size_t size, struct memtype *mem)
+int queue_init(struct queue *q, size_t size, struct memtype *mem, int flags)
 {
 	assert(q->state == STATE_DESTROYED);
 
@@ -48,6 +48,7 @@ int queue_init(struct queue *q, size_t size, struct memtype *mem)
 	}
 
 	q->mem = mem;
+	q->flags = flags;
 	q->buffer_mask = size - 1;
 	struct queue_cell *buffer = (struct queue_cell *) memory_alloc(q->mem, sizeof(struct queue_cell) * size);
 	if (!buffer)
@@ -61,11 +62,25 @@ int queue_init(struct queue *q, size_t size, struct memtype *mem)
 	atomic_store_explicit(&q->tail, 0, memory_order_relaxed);
 	atomic_store_explicit(&q->head, 0, memory_order_relaxed);
 
+	q->head_cache = 0;
+	q->tail_cache = 0;
+
+	atomic_store_explicit(&q->highwater, 0, memory_order_relaxed);
+	atomic_store_explicit(&q->failures, 0, memory_order_relaxed);
+
 	q->state = STATE_INITIALIZED;
 
 	return 0;
 }
 
+size_t queue_footprint(size_t size)
+{
+	if (!IS_POW2(size))
+		size = LOG2_CEIL(size);
+
+	return memory_footprint(sizeof(struct queue_cell) * size, sizeof(void *));
+}
+
 int queue_destroy(struct queue *q)
 {
 	void *buffer = (char *) q + q->buffer_off;
@@ -88,15 +103,91 @@ size_t queue_available(struct queue *q)
 		atomic_load_explicit(&q->head, memory_order_relaxed);
 }
 
-int queue_push(struct queue *q, void *ptr)
+void queue_occupancy(struct queue *q, struct queue_occupancy *o)
+{
+	o->capacity = q->buffer_mask + 1;
+	o->fill = queue_available(q);
+	o->highwater = atomic_load_explicit(&q->highwater, memory_order_relaxed);
+	o->failures = atomic_load_explicit(&q->failures, memory_order_relaxed);
+}
+
+/** Update the occupancy counters after \p pushed out of \p cnt pointers have been enqueued. */
+static void queue_occupancy_update(struct queue *q, int pushed, size_t cnt)
+{
+	size_t fill, highwater;
+
+	if (pushed < 0)
+		return;
+
+	if (pushed < cnt)
+		atomic_fetch_add_explicit(&q->failures, cnt - pushed, memory_order_relaxed);
+
+	fill = queue_available(q);
+	highwater = atomic_load_explicit(&q->highwater, memory_order_relaxed);
+
+	while (fill > highwater && !atomic_compare_exchange_weak_explicit(&q->highwater, &highwater, fill, memory_order_relaxed, memory_order_relaxed));
+}
+
+/** Single-producer, single-consumer variant of queue_push_many()
+ *
+ * The producer only reloads the head pointer of the consumer if its cached copy indicates a full queue.
+ */
+static int queue_spsc_push_many(struct queue *q, void *ptr[], size_t cnt)
+{
+	struct queue_cell *buffer;
+	size_t tail, free, size = q->buffer_mask + 1;
+
+	buffer = (struct queue_cell *) ((char *) q + q->buffer_off);
+	tail = atomic_load_explicit(&q->tail, memory_order_relaxed);
+
+	free = size - (tail - q->head_cache);
+	if (free < cnt) {
+		q->head_cache = atomic_load_explicit(&q->head, memory_order_acquire);
+		free = size - (tail - q->head_cache);
+	}
+
+	cnt = MIN(cnt, free);
+	for (size_t i = 0; i < cnt; i++)
+		buffer[(tail + i) & q->buffer_mask].data_off = (char *) ptr[i] - (char *) q;
+
+	atomic_store_explicit(&q->tail, tail + cnt, memory_order_release);
+
+	return cnt;
+}
+
+/** Single-producer, single-consumer variant of queue_pull_many()
+ *
+ * The consumer only reloads the tail pointer of the producer if its cached copy indicates an empty queue.
+ */
+static int queue_spsc_pull_many(struct queue *q, void *ptr[], size_t cnt)
+{
+	struct queue_cell *buffer;
+	size_t head, avail;
+
+	buffer = (struct queue_cell *) ((char *) q + q->buffer_off);
+	head = atomic_load_explicit(&q->head, memory_order_relaxed);
+
+	avail = q->tail_cache - head;
+	if (avail < cnt) {
+		q->tail_cache = atomic_load_explicit(&q->tail, memory_order_acquire);
+		avail = q->tail_cache - head;
+	}
+
+	cnt = MIN(cnt, avail);
+	for (size_t i = 0; i < cnt; i++)
+		ptr[i] = (char *) q + buffer[(head + i) & q->buffer_mask].data_off;
+
+	atomic_store_explicit(&q->head, head + cnt, memory_order_release);
+
+	return cnt;
+}
+
+static int queue_mpmc_push(struct queue *q, void *ptr)
 {
 	struct queue_cell *cell, *buffer;
 	size_t pos, seq;
 	intptr_t diff;
 
-	if (atomic_load_explicit(&q->state, memory_order_relaxed) == STATE_STOPPED)
-		return -1;
-
 	buffer = (struct queue_cell *) ((char *) q + q->buffer_off);
 	pos = atomic_load_explicit(&q->tail, memory_order_relaxed);
 	for (;;) {
@@ -120,6 +211,24 @@ int queue_push(struct queue *q, void *ptr)
 	return 1;
 }
 
+int queue_push(struct queue *q, void *ptr)
+{
+	int ret;
+
+	if (atomic_load_explicit(&q->state, memory_order_relaxed) == STATE_STOPPED)
+		return -1;
+
+	if (q->flags & QUEUE_SPSC)
+		ret = queue_spsc_push_many(q, &ptr, 1);
+	else
+		ret = queue_mpmc_push(q, ptr);
+
+	if (q->flags & QUEUE_OCCUPANCY)
+		queue_occupancy_update(q, ret, 1);
+
+	return ret;
+}
+
 int queue_pull(struct queue *q, void **ptr)
 {
 	struct queue_cell *cell, *buffer;
@@ -129,6 +238,9 @@ int queue_pull(struct queue *q, void **ptr)
 	if (atomic_load_explicit(&q->state, memory_order_relaxed) == STATE_STOPPED)
 		return -1;
 
+	if (q->flags & QUEUE_SPSC)
+		return queue_spsc_pull_many(q, ptr, 1);
+
 	buffer = (struct queue_cell *) ((char *) q + q->buffer_off);
 	pos = atomic_load_explicit(&q->head, memory_order_relaxed);
 	for (;;) {
@@ -152,38 +264,112 @@ int queue_pull(struct queue *q, void **ptr)
 	return 1;
 }
 
-int queue_push_many(struct queue *q, void *ptr[], size_t cnt)
+static int queue_mpmc_push_many(struct queue *q, void *ptr[], size_t cnt)
 {
-	int ret;
-	size_t i;
+	struct queue_cell *buffer;
+	size_t pos, seq, i;
+	intptr_t diff;
+
+	buffer = (struct queue_cell *) ((char *) q + q->buffer_off);
+	pos = atomic_load_explicit(&q->tail, memory_order_relaxed);
+	for (;;) {
+		/* Count the consecutive cells which are free for this lap */
+		for (i = 0; i < cnt; i++) {
+			seq = atomic_load_explicit(&buffer[(pos + i) & q->buffer_mask].sequence, memory_order_acquire);
+			diff = (intptr_t) seq - (intptr_t) (pos + i);
+			if (diff != 0)
+				break;
+		}
 
+		if (i > 0) {
+			/* Reserve all of them with a single CAS */
+			if (atomic_compare_exchange_weak_explicit(&q->tail, &pos, pos + i, memory_order_relaxed, memory_order_relaxed))
+				break;
+		}
+		else if (diff < 0)
+			return 0; /* The queue is full */
+		else
+			pos = atomic_load_explicit(&q->tail, memory_order_relaxed);
+	}
+
+	cnt = i;
 	for (i = 0; i < cnt; i++) {
-		ret = queue_push(q, ptr[i]);
-		if (ret <= 0)
-			break;
+		struct queue_cell *cell = &buffer[(pos + i) & q->buffer_mask];
+
+		cell->data_off = (char *) ptr[i] - (char *) q;
+		atomic_store_explicit(&cell->sequence, pos + i + 1, memory_order_release);
 	}
 
-	if (ret == -1 && i == 0)
+	return cnt;
+}
+
+int queue_push_many(struct queue *q, void *ptr[], size_t cnt)
+{
+	int ret;
+
+	if (atomic_load_explicit(&q->state, memory_order_relaxed) == STATE_STOPPED)
 		return -1;
 
-	return i;
+	if (cnt == 0)
+		return 0;
+
+	if (q->flags & QUEUE_SPSC)
+		ret = queue_spsc_push_many(q, ptr, cnt);
+	else
+		ret = queue_mpmc_push_many(q, ptr, cnt);
+
+	if (q->flags & QUEUE_OCCUPANCY)
+		queue_occupancy_update(q, ret, cnt);
+
+	return ret;
 }
 
 int queue_pull_many(struct queue *q, void *ptr[], size_t cnt)
 {
-	int ret;
-	size_t i;
+	struct queue_cell *buffer;
+	size_t pos, seq, i;
+	intptr_t diff;
 
-	for (i = 0; i < cnt; i++) {
-		ret = queue_pull(q, &ptr[i]);
-		if (ret <= 0)
-			break;
+	if (atomic_load_explicit(&q->state, memory_order_relaxed) == STATE_STOPPED)
+		return -1;
+
+	if (cnt == 0)
+		return 0;
+
+	if (q->flags & QUEUE_SPSC)
+		return queue_spsc_pull_many(q, ptr, cnt);
+
+	buffer = (struct queue_cell *) ((char *) q + q->buffer_off);
+	pos = atomic_load_explicit(&q->head, memory_order_relaxed);
+	for (;;) {
+		/* Count the consecutive cells which have been filled by producers */
+		for (i = 0; i < cnt; i++) {
+			seq = atomic_load_explicit(&buffer[(pos + i) & q->buffer_mask].sequence, memory_order_acquire);
+			diff = (intptr_t) seq - (intptr_t) (pos + i + 1);
+			if (diff != 0)
+				break;
+		}
+
+		if (i > 0) {
+			/* Reserve all of them with a single CAS */
+			if (atomic_compare_exchange_weak_explicit(&q->head, &pos, pos + i, memory_order_relaxed, memory_order_relaxed))
+				break;
+		}
+		else if (diff < 0)
+			return 0; /* The queue is empty */
+		else
+			pos = atomic_load_explicit(&q->head, memory_order_relaxed);
 	}
 
-	if (ret == -1 && i == 0)
-		return -1;
+	cnt = i;
+	for (i = 0; i < cnt; i++) {
+		struct queue_cell *cell = &buffer[(pos + i) & q->buffer_mask];
+
+		ptr[i] = (char *) q + cell->data_off;
+		atomic_store_explicit(&cell->sequence, pos + i + q->buffer_mask + 1, memory_order_release);
+	}
 
-	return i;
+	return cnt;
 }
 
 int queue_close(struct queue *q)
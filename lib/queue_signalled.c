@@ -21,11 +21,17 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  *********************************************************************************/
 
+#include <limits.h>
+
+#include "config.h"
 #include "queue_signalled.h"
 #include "log.h"
 
 #ifdef __linux__
+  #include <time.h>
   #include <sys/eventfd.h>
+  #include <sys/syscall.h>
+  #include <linux/futex.h>
 #endif
 
 static void queue_signalled_cleanup(void *p)
@@ -36,6 +42,59 @@ static void queue_signalled_cleanup(void *p)
 		pthread_mutex_unlock(&qs->pthread.mutex);
 }
 
+#ifdef __linux__
+static int queue_signalled_futex(atomic_uint *uaddr, int op, unsigned val, const struct timespec *ts)
+{
+	return syscall(SYS_futex, uaddr, op, val, ts, NULL, 0);
+}
+
+/** Spin once or block until a producer might have pushed new data. */
+static void queue_signalled_adaptive_wait(struct queue_signalled *qs, int *spins)
+{
+	if ((*spins)++ < qs->adaptive.spin) {
+#if defined(__x86_64__) || defined(__i386__)
+		__builtin_ia32_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+		__asm__ __volatile__ ("yield");
+#endif
+		return;
+	}
+
+	unsigned seq = atomic_load(&qs->adaptive.seq);
+
+	/* Announce that we are going to sleep before checking the queue a last time.
+	 * A producer either sees the announcement or we see its data. */
+	atomic_fetch_add(&qs->adaptive.waiters, 1);
+	atomic_thread_fence(memory_order_seq_cst);
+
+	if (queue_available(&qs->queue) == 0) {
+		/* The futex syscall is no cancellation point. Hence we wake up periodically. */
+		struct timespec ts = { .tv_sec = 0, .tv_nsec = QUEUE_SIGNALLED_TIMEOUT };
+
+		queue_signalled_futex(&qs->adaptive.seq, qs->adaptive.shared ? FUTEX_WAIT : FUTEX_WAIT_PRIVATE, seq, &ts);
+	}
+
+	atomic_fetch_sub(&qs->adaptive.waiters, 1);
+
+	*spins = 0;
+
+	pthread_testcancel();
+}
+
+/** Wake up consumers, but only if there are any. */
+static void queue_signalled_adaptive_wake(struct queue_signalled *qs, int force)
+{
+	/* Pairs with the announcement in queue_signalled_adaptive_wait() */
+	atomic_thread_fence(memory_order_seq_cst);
+
+	if (force || atomic_load(&qs->adaptive.waiters) > 0) {
+		atomic_fetch_add(&qs->adaptive.seq, 1);
+
+		queue_signalled_futex(&qs->adaptive.seq, qs->adaptive.shared ? FUTEX_WAKE : FUTEX_WAKE_PRIVATE, INT_MAX, NULL);
+	}
+}
+#endif
+
 int queue_signalled_init(struct queue_signalled *qs, size_t size, struct memtype *mem, int flags)
 {
 	int ret;
@@ -53,7 +112,15 @@ int queue_signalled_init(struct queue_signalled *qs, size_t size, struct memtype
 #endif
 	}
 
-	ret = queue_init(&qs->queue, size, mem);
+	int qflags = QUEUE_MPMC;
+
+	if (flags & QUEUE_SIGNALLED_SPSC)
+		qflags |= QUEUE_SPSC;
+
+	if (flags & QUEUE_SIGNALLED_OCCUPANCY)
+		qflags |= QUEUE_OCCUPANCY;
+
+	ret = queue_init(&qs->queue, size, mem, qflags);
 	if (ret < 0)
 		return ret;
 
@@ -84,6 +151,13 @@ int queue_signalled_init(struct queue_signalled *qs, size_t size, struct memtype
 		if (qs->eventfd < 0)
 			return -2;
 	}
+	else if (qs->mode == QUEUE_SIGNALLED_ADAPTIVE) {
+		atomic_init(&qs->adaptive.seq, 0);
+		atomic_init(&qs->adaptive.waiters, 0);
+
+		qs->adaptive.spin = QUEUE_SIGNALLED_SPIN;
+		qs->adaptive.shared = flags & QUEUE_SIGNALLED_PROCESS_SHARED ? 1 : 0;
+	}
 #endif
 	else
 		return -1;
@@ -112,6 +186,9 @@ int queue_signalled_destroy(struct queue_signalled *qs)
 		if (ret)
 			return ret;
 	}
+	else if (qs->mode == QUEUE_SIGNALLED_ADAPTIVE) {
+		/* Nothing todo */
+	}
 #endif
 	else
 		return -1;
@@ -143,6 +220,8 @@ int queue_signalled_push(struct queue_signalled *qs, void *ptr)
 		if (ret < 0)
 			return ret;
 	}
+	else if (qs->mode == QUEUE_SIGNALLED_ADAPTIVE)
+		queue_signalled_adaptive_wake(qs, 0);
 #endif
 	else
 		return -1;
@@ -174,6 +253,8 @@ int queue_signalled_push_many(struct queue_signalled *qs, void *ptr[], size_t cn
 		if (ret < 0)
 			return ret;
 	}
+	else if (qs->mode == QUEUE_SIGNALLED_ADAPTIVE)
+		queue_signalled_adaptive_wake(qs, 0);
 #endif
 	else
 		return -1;
@@ -183,7 +264,7 @@ int queue_signalled_push_many(struct queue_signalled *qs, void *ptr[], size_t cn
 
 int queue_signalled_pull(struct queue_signalled *qs, void **ptr)
 {
-	int pulled = 0;
+	int pulled = 0, spins = 0;
 
 	/* Make sure that qs->mutex is unlocked if this thread gets cancelled. */
 	pthread_cleanup_push(queue_signalled_cleanup, qs);
@@ -208,6 +289,8 @@ int queue_signalled_pull(struct queue_signalled *qs, void **ptr)
 				if (ret < 0)
 					break;
 			}
+			else if (qs->mode == QUEUE_SIGNALLED_ADAPTIVE)
+				queue_signalled_adaptive_wait(qs, &spins);
 #endif
 			else
 				break;
@@ -224,7 +307,7 @@ int queue_signalled_pull(struct queue_signalled *qs, void **ptr)
 
 int queue_signalled_pull_many(struct queue_signalled *qs, void *ptr[], size_t cnt)
 {
-	int pulled = 0;
+	int pulled = 0, spins = 0;
 
 	/* Make sure that qs->mutex is unlocked if this thread gets cancelled. */
 	pthread_cleanup_push(queue_signalled_cleanup, qs);
@@ -249,6 +332,8 @@ int queue_signalled_pull_many(struct queue_signalled *qs, void *ptr[], size_t cn
 				if (ret < 0)
 					break;
 			}
+			else if (qs->mode == QUEUE_SIGNALLED_ADAPTIVE)
+				queue_signalled_adaptive_wait(qs, &spins);
 #endif
 			else
 				break;
@@ -263,6 +348,24 @@ int queue_signalled_pull_many(struct queue_signalled *qs, void *ptr[], size_t cn
 	return pulled;
 }
 
+int queue_signalled_pull_many_ready(struct queue_signalled *qs, void *ptr[], size_t cnt)
+{
+#ifdef __linux__
+	if (qs->mode == QUEUE_SIGNALLED_EVENTFD) {
+		int ret;
+		uint64_t cntr;
+
+		/* Reset the counter first: every push after this point will
+		 * make the eventfd readable again. */
+		ret = read(qs->eventfd, &cntr, sizeof(cntr));
+		if (ret < 0)
+			return ret;
+	}
+#endif
+
+	return queue_pull_many(&qs->queue, ptr, cnt);
+}
+
 int queue_signalled_close(struct queue_signalled *qs)
 {
 	int ret;
@@ -288,6 +391,8 @@ int queue_signalled_close(struct queue_signalled *qs)
 		if (ret < 0)
 			return ret;
 	}
+	else if (qs->mode == QUEUE_SIGNALLED_ADAPTIVE)
+		queue_signalled_adaptive_wake(qs, 1);
 #endif
 	else
 		return -1;
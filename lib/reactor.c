@@ -0,0 +1,302 @@
+/** Shared event loop which multiplexes many paths onto a small pool of worker threads.
+ *
+ * @author Steffen Vogel <stvogel@eonerc.rwth-aachen.de>
+ * @copyright 2017, Institute for Automation of Complex Power Systems, EONERC
+ * @license GNU General Public License (version 3)
+ *
+ * VILLASnode
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *********************************************************************************/
+
+#include <errno.h>
+#include <poll.h>
+#include <sched.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+
+#include "config.h"
+#include "utils.h"
+#include "reactor.h"
+
+/** Check without blocking if there is more data available */
+static int reactor_fd_ready(int fd)
+{
+	struct pollfd pfd = {
+		.fd = fd,
+		.events = POLLIN
+	};
+
+	return poll(&pfd, 1, 0) > 0 && (pfd.revents & POLLIN);
+}
+
+static void * reactor_worker_run(void *arg)
+{
+	int ret, n, nbusy = 0;
+	struct reactor_worker *w = arg;
+
+	struct epoll_event evs[REACTOR_MAX_EVENTS];
+	struct reactor_watch *busy[REACTOR_MAX_EVENTS];
+
+	if (w->cpu >= 0) {
+		cpu_set_t cset;
+
+		CPU_ZERO(&cset);
+		CPU_SET(w->cpu, &cset);
+
+		ret = pthread_setaffinity_np(pthread_self(), sizeof(cset), &cset);
+		if (ret)
+			warn("Failed to pin reactor worker to CPU %d", w->cpu);
+	}
+
+	for (;;) {
+		/* Descriptors which have not been drained in the last round
+		 * are serviced again without waiting for a new edge. */
+		if (nbusy < REACTOR_MAX_EVENTS) {
+			n = epoll_wait(w->epfd, evs, REACTOR_MAX_EVENTS - nbusy, nbusy ? 0 : -1);
+			if (n < 0) {
+				if (errno == EINTR)
+					continue;
+
+				serror("Failed to wait for events");
+			}
+
+			for (int i = 0; i < n; i++) {
+				struct reactor_watch *rw = evs[i].data.ptr;
+				int found = 0;
+
+				/* The callback might block if there is nothing to read */
+				if (!(evs[i].events & EPOLLIN)) {
+					if (evs[i].events & (EPOLLERR | EPOLLHUP) && rw->err)
+						rw->err(rw->ctx, rw->idx);
+
+					continue;
+				}
+
+				for (int j = 0; j < nbusy; j++) {
+					if (busy[j] == rw) {
+						found = 1;
+						break;
+					}
+				}
+
+				if (!found)
+					busy[nbusy++] = rw;
+			}
+		}
+
+		int remaining = 0;
+		for (int i = 0; i < nbusy; i++) {
+			struct reactor_watch *rw = busy[i];
+			int ready = 1;
+
+			for (int j = 0; j < REACTOR_MAX_DRAIN && ready; j++) {
+				rw->cb(rw->ctx, rw->idx);
+
+				ready = reactor_fd_ready(rw->fd);
+			}
+
+			if (ready)
+				busy[remaining++] = rw;
+		}
+
+		nbusy = remaining;
+	}
+
+	return NULL;
+}
+
+int reactor_init(struct reactor *r, int nworkers, int affinity)
+{
+	int ncpus = 0, cpus[sizeof(affinity) * 8];
+
+	assert(r->state == STATE_DESTROYED);
+
+	if (nworkers <= 0)
+		return -1;
+
+	for (int i = 0; i < sizeof(affinity) * 8; i++) {
+		if ((unsigned) affinity & (1U << i))
+			cpus[ncpus++] = i;
+	}
+
+	r->affinity = affinity;
+	r->nworkers = nworkers;
+	r->workers = alloc(nworkers * sizeof(struct reactor_worker));
+
+	for (int i = 0; i < nworkers; i++) {
+		struct reactor_worker *w = &r->workers[i];
+
+		w->reactor = r;
+		w->load = 0;
+		w->cpu = ncpus > 0 ? cpus[i % ncpus] : -1;
+
+		w->epfd = epoll_create1(EPOLL_CLOEXEC);
+		if (w->epfd < 0)
+			return -1;
+
+		list_init(&w->watches);
+	}
+
+	r->state = STATE_INITIALIZED;
+
+	return 0;
+}
+
+int reactor_destroy(struct reactor *r)
+{
+	int ret;
+
+	assert(r->state != STATE_DESTROYED && r->state != STATE_STARTED);
+
+	for (int i = 0; i < r->nworkers; i++) {
+		struct reactor_worker *w = &r->workers[i];
+
+		ret = close(w->epfd);
+		if (ret)
+			return ret;
+
+		list_destroy(&w->watches, NULL, true);
+	}
+
+	free(r->workers);
+
+	r->state = STATE_DESTROYED;
+
+	return 0;
+}
+
+int reactor_start(struct reactor *r)
+{
+	int ret;
+
+	assert(r->state == STATE_INITIALIZED);
+
+	info("Starting reactor: #workers=%d", r->nworkers);
+
+	for (int i = 0; i < r->nworkers; i++) {
+		struct reactor_worker *w = &r->workers[i];
+
+		ret = pthread_create(&w->tid, NULL, reactor_worker_run, w);
+		if (ret)
+			return ret;
+	}
+
+	r->state = STATE_STARTED;
+
+	return 0;
+}
+
+int reactor_stop(struct reactor *r)
+{
+	int ret;
+
+	if (r->state != STATE_STARTED)
+		return 0;
+
+	info("Stopping reactor");
+
+	for (int i = 0; i < r->nworkers; i++) {
+		struct reactor_worker *w = &r->workers[i];
+
+		ret = pthread_cancel(w->tid);
+		if (ret)
+			return ret;
+
+		ret = pthread_join(w->tid, NULL);
+		if (ret)
+			return ret;
+	}
+
+	r->state = STATE_STOPPED;
+
+	return 0;
+}
+
+int reactor_assign(struct reactor *r)
+{
+	int worker = 0;
+
+	for (int i = 1; i < r->nworkers; i++) {
+		if (r->workers[i].load < r->workers[worker].load)
+			worker = i;
+	}
+
+	r->workers[worker].load++;
+
+	return worker;
+}
+
+int reactor_add(struct reactor *r, int worker, int fd, reactor_cb_t cb, reactor_cb_t err, void *ctx, int idx)
+{
+	int ret;
+	struct reactor_worker *w = &r->workers[worker];
+	struct reactor_watch *rw = alloc(sizeof(struct reactor_watch));
+
+	rw->fd = fd;
+	rw->idx = idx;
+	rw->ctx = ctx;
+	rw->cb = cb;
+	rw->err = err;
+
+	struct epoll_event ev = {
+		.events = EPOLLIN | EPOLLET,
+		.data.ptr = rw
+	};
+
+	ret = epoll_ctl(w->epfd, EPOLL_CTL_ADD, fd, &ev);
+	if (ret) {
+		free(rw);
+		return ret;
+	}
+
+	list_push(&w->watches, rw);
+
+	debug(LOG_PATH | 10, "Added fd=%d to reactor worker %d", fd, worker);
+
+	return 0;
+}
+
+int reactor_remove(struct reactor *r, void *ctx)
+{
+	int ret;
+
+	for (int i = 0; i < r->nworkers; i++) {
+		struct reactor_worker *w = &r->workers[i];
+		int removed = 0;
+
+		for (size_t j = 0; j < list_length(&w->watches); ) {
+			struct reactor_watch *rw = (struct reactor_watch *) list_at(&w->watches, j);
+
+			if (rw->ctx != ctx) {
+				j++;
+				continue;
+			}
+
+			ret = epoll_ctl(w->epfd, EPOLL_CTL_DEL, rw->fd, NULL);
+			if (ret)
+				return ret;
+
+			list_remove(&w->watches, rw);
+			free(rw);
+
+			removed++;
+		}
+
+		if (removed)
+			w->load--;
+	}
+
+	return 0;
+}
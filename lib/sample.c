@@ -29,15 +29,28 @@
 #include "utils.h"
 #include "timing.h"
 
+/** Get the bitfield which stores the number representation of the values beyond SAMPLE_FORMAT_INLINE. */
+static uint64_t * sample_format_ext(struct sample *s)
+{
+	return (uint64_t *) &s->data[s->capacity];
+}
+
 int sample_init(struct sample *s)
 {
 	struct pool *p = sample_pool(s);
+	size_t avail = p->blocksz - sizeof(struct sample);
 
 	s->length = 0;
 	s->format = 0; /* all sample values are float by default */
-	s->capacity = (p->blocksz - sizeof(struct sample)) / sizeof(s->data[0]);
 	s->refcnt = ATOMIC_VAR_INIT(1);
 
+	/* Reserve space for the format bitfield of values beyond SAMPLE_FORMAT_INLINE */
+	s->capacity = avail / sizeof(s->data[0]);
+	while (SAMPLE_DATA_LEN(s->capacity) + SAMPLE_FORMAT_LEN(s->capacity) > avail)
+		s->capacity--;
+
+	memset(sample_format_ext(s), 0, SAMPLE_FORMAT_LEN(s->capacity));
+
 	return 0;
 }
 
@@ -133,6 +146,7 @@ int sample_copy(struct sample *dst, struct sample *src)
 	dst->ts = src->ts;
 
 	memcpy(&dst->data, &src->data, SAMPLE_DATA_LEN(dst->length));
+	memcpy(sample_format_ext(dst), sample_format_ext(src), SAMPLE_FORMAT_LEN(dst->length));
 
 	return 0;
 }
@@ -226,6 +240,11 @@ int sample_cmp(struct sample *a, struct sample *b, double epsilon, int flags)
 		}
 
 		for (int i = 0; i < a->length; i++) {
+			if (i >= SAMPLE_FORMAT_INLINE && sample_get_data_format(a, i) != sample_get_data_format(b, i)) {
+				printf("format of data[%d]: %d != %d\n", i, sample_get_data_format(a, i), sample_get_data_format(b, i));
+				return 6;
+			}
+
 			switch (sample_get_data_format(a, i)) {
 				case SAMPLE_DATA_FORMAT_FLOAT:
 					if (fabs(a->data[i].f - b->data[i].f) > epsilon) {
@@ -249,12 +268,22 @@ int sample_cmp(struct sample *a, struct sample *b, double epsilon, int flags)
 
 int sample_set_data_format(struct sample *s, int idx, enum sample_data_format fmt)
 {
-	if (idx >= sizeof(s->format) * 8)
-		return 0; /* we currently can only control the format of the first 64 values. */
+	uint64_t *bits;
+
+	if (idx < 0 || idx >= s->capacity)
+		return -1;
+
+	if (idx < SAMPLE_FORMAT_INLINE)
+		bits = &s->format;
+	else {
+		idx -= SAMPLE_FORMAT_INLINE;
+		bits = &sample_format_ext(s)[idx / 64];
+		idx %= 64;
+	}
 
 	switch (fmt) {
-		case SAMPLE_DATA_FORMAT_FLOAT: s->format &= ~(1   << idx); break;
-		case SAMPLE_DATA_FORMAT_INT:   s->format |=  (fmt << idx); break;
+		case SAMPLE_DATA_FORMAT_FLOAT: *bits &= ~(1ULL << idx); break;
+		case SAMPLE_DATA_FORMAT_INT:   *bits |=  (1ULL << idx); break;
 	}
 
 	return 0;
@@ -262,8 +291,13 @@ int sample_set_data_format(struct sample *s, int idx, enum sample_data_format fm
 
 int sample_get_data_format(struct sample *s, int idx)
 {
-	if (idx >= sizeof(s->format) * 8)
-		return -1; /* we currently can only control the format of the first 64 values. */
+	if (idx < 0 || idx >= s->capacity)
+		return -1;
+
+	if (idx < SAMPLE_FORMAT_INLINE)
+		return (s->format >> idx) & 0x1;
+
+	idx -= SAMPLE_FORMAT_INLINE;
 
-	return (s->format >> idx) & 0x1;
+	return (sample_format_ext(s)[idx / 64] >> (idx % 64)) & 0x1;
 }
@@ -0,0 +1,166 @@
+/** A structure-of-arrays representation of a batch of samples.
+ *
+ * @author Steffen Vogel <stvogel@eonerc.rwth-aachen.de>
+ * @copyright 2017, Institute for Automation of Complex Power Systems, EONERC
+ * @license GNU General Public License (version 3)
+ *
+ * VILLASnode
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *********************************************************************************/
+
+#include <string.h>
+
+#include "sample.h"
+#include "sample_batch.h"
+#include "memory.h"
+#include "utils.h"
+
+int sample_batch_init(struct sample_batch *b, int capacity, int values, struct memtype *m)
+{
+	char *buffer;
+	size_t off_sequence, off_lengths, off_flags, off_origin, off_received, off_format;
+
+	assert(b->state == STATE_DESTROYED);
+
+	if (capacity <= 0 || values < 0)
+		return -1;
+
+	b->mem = m;
+	b->length = 0;
+	b->capacity = capacity;
+	b->values = values;
+
+	/* Every column starts at a SAMPLE_BATCH_ALIGN boundary */
+	b->stride = ALIGN(capacity, SAMPLE_BATCH_ALIGN / sizeof(union sample_batch_value));
+
+	/* All arrays are placed in a single allocation */
+	off_sequence = ALIGN(values * b->stride * sizeof(union sample_batch_value), SAMPLE_BATCH_ALIGN);
+	off_lengths  = ALIGN(off_sequence + capacity * sizeof(int), SAMPLE_BATCH_ALIGN);
+	off_flags    = ALIGN(off_lengths  + capacity * sizeof(int), SAMPLE_BATCH_ALIGN);
+	off_origin   = ALIGN(off_flags    + capacity * sizeof(int), SAMPLE_BATCH_ALIGN);
+	off_received = ALIGN(off_origin   + capacity * sizeof(struct timespec), SAMPLE_BATCH_ALIGN);
+
+	off_format   = ALIGN(off_received + capacity * sizeof(struct timespec), SAMPLE_BATCH_ALIGN);
+
+	b->len = off_format + CEIL(values, 64) * sizeof(uint64_t);
+
+	buffer = memory_alloc_aligned(m, b->len, SAMPLE_BATCH_ALIGN);
+	if (!buffer)
+		return -1;
+
+	b->data     = (union sample_batch_value *) buffer;
+	b->sequence = (int *) (buffer + off_sequence);
+	b->lengths  = (int *) (buffer + off_lengths);
+	b->flags    = (int *) (buffer + off_flags);
+	b->origin   = (struct timespec *) (buffer + off_origin);
+	b->received = (struct timespec *) (buffer + off_received);
+	b->format   = (uint64_t *) (buffer + off_format);
+
+	memset(b->format, 0, CEIL(values, 64) * sizeof(uint64_t));
+
+	b->state = STATE_INITIALIZED;
+
+	return 0;
+}
+
+int sample_batch_destroy(struct sample_batch *b)
+{
+	int ret;
+
+	if (b->state == STATE_DESTROYED)
+		return 0;
+
+	ret = memory_free(b->mem, b->data, b->len);
+	if (ret)
+		return ret;
+
+	b->state = STATE_DESTROYED;
+
+	return 0;
+}
+
+int sample_batch_from_samples(struct sample_batch *b, struct sample *smps[], int cnt)
+{
+	cnt = MIN(cnt, b->capacity);
+
+	/* Values beyond sample::length of the first sample are treated as floats */
+	for (int i = 0; i < b->values; i++) {
+		int fmt = cnt > 0 && i < smps[0]->length ? sample_get_data_format(smps[0], i) : SAMPLE_DATA_FORMAT_FLOAT;
+
+		if (fmt == SAMPLE_DATA_FORMAT_INT)
+			b->format[i / 64] |= 1ULL << (i % 64);
+		else
+			b->format[i / 64] &= ~(1ULL << (i % 64));
+	}
+
+	for (int j = 0; j < cnt; j++) {
+		struct sample *smp = smps[j];
+
+		b->sequence[j] = smp->sequence;
+		b->lengths[j]  = MIN(smp->length, b->values);
+		b->flags[j]    = smp->flags;
+		b->origin[j]   = smp->ts.origin;
+		b->received[j] = smp->ts.received;
+	}
+
+	/* Transpose column by column so that the stores are sequential */
+	for (int i = 0; i < b->values; i++) {
+		union sample_batch_value *col = sample_batch_column(b, i);
+
+		for (int j = 0; j < cnt; j++) {
+			struct sample *smp = smps[j];
+
+			if (i < smp->length)
+				col[j].i = smp->data[i].i;
+			else
+				col[j].i = 0;
+		}
+	}
+
+	b->length = cnt;
+
+	return cnt;
+}
+
+int sample_batch_to_samples(struct sample_batch *b, struct sample *smps[], int cnt)
+{
+	cnt = MIN(cnt, b->length);
+
+	for (int j = 0; j < cnt; j++) {
+		struct sample *smp = smps[j];
+
+		smp->sequence    = b->sequence[j];
+		smp->length      = MIN(b->lengths[j], smp->capacity);
+		smp->flags       = b->flags[j];
+		smp->ts.origin   = b->origin[j];
+		smp->ts.received = b->received[j];
+
+		for (int i = 0; i < smp->length; i++)
+			sample_set_data_format(smp, i, (b->format[i / 64] >> (i % 64)) & 0x1);
+	}
+
+	for (int i = 0; i < b->values; i++) {
+		union sample_batch_value *col = sample_batch_column(b, i);
+
+		for (int j = 0; j < cnt; j++) {
+			struct sample *smp = smps[j];
+
+			if (i < smp->length)
+				smp->data[i].i = col[j].i;
+		}
+	}
+
+	return cnt;
+}
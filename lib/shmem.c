@@ -35,8 +35,9 @@
 
 size_t shmem_total_size(int queuelen, int samplelen)
 {
-	/* We have the constant const of the memtype header */
+	/* We have the constant const of the memtype header and its free lists */
 	return sizeof(struct memtype)
+		+ sizeof(struct memmanager)
 		/* and the shared struct itself */
 		+ sizeof(struct shmem_shared)
 		/* the size of the actual queue and the queue for the pool */
@@ -92,11 +93,14 @@ int shmem_int_open(const char *wname, const char* rname, struct shmem_int *shm,
 	}
 
 	memset(shared, 0, sizeof(struct shmem_shared));
+	shared->version = SHMEM_VERSION;
 	shared->polling = conf->polling;
 
 	int flags = QUEUE_SIGNALLED_PROCESS_SHARED;
 	if (conf->polling)
 		flags |= QUEUE_SIGNALLED_POLLING;
+	else if (conf->spin > 0)
+		flags |= QUEUE_SIGNALLED_ADAPTIVE;
 	else
 		flags |= QUEUE_SIGNALLED_PTHREAD;
 
@@ -106,6 +110,9 @@ int shmem_int_open(const char *wname, const char* rname, struct shmem_int *shm,
 		return -1;
 	}
 
+	if (conf->spin > 0 && !conf->polling)
+		shared->queue.adaptive.spin = conf->spin;
+
 	ret = pool_init(&shared->pool, conf->queuelen, SAMPLE_LEN(conf->samplelen), manager);
 	if (ret) {
 		errno = ENOMEM;
@@ -136,8 +143,21 @@ int shmem_int_open(const char *wname, const char* rname, struct shmem_int *shm,
 	if (base == MAP_FAILED)
 		return -1;
 
-	cptr = (char *) base + sizeof(struct memtype) + sizeof(struct memblock);
+	cptr = (char *) base + sizeof(struct memtype) + sizeof(struct memmanager) + sizeof(struct memblock);
 	shared = (struct shmem_shared *) cptr;
+
+	/* Both processes must agree on the layout of the shared region */
+	if (shared->version != SHMEM_VERSION) {
+		munmap(base, len);
+
+		/* Nobody will use our own region either */
+		munmap(shm->write.base, shm->write.len);
+		shm_unlink(wname);
+
+		errno = EPROTO;
+		return -1;
+	}
+
 	shm->read.base = base;
 	shm->read.name = rname;
 	shm->read.len = len;
@@ -31,6 +31,8 @@
 #include "log.h"
 #include "node.h"
 #include "table.h"
+#include "pool.h"
+#include "queue.h"
 
 static struct stats_desc {
 	const char *name;
@@ -65,6 +67,10 @@ int stats_init(struct stats *s, int buckets, int warmup)
 
 	s->delta = alloc(sizeof(struct stats_delta));
 
+	list_init(&s->pools);
+	list_init(&s->queues);
+	list_init(&s->overruns);
+
 	return 0;
 }
 
@@ -75,6 +81,10 @@ int stats_destroy(struct stats *s)
 
 	free(s->delta);
 
+	list_destroy(&s->pools, NULL, false);
+	list_destroy(&s->queues, NULL, false);
+	list_destroy(&s->overruns, NULL, false);
+
 	return 0;
 }
 
@@ -107,19 +117,95 @@ json_t * stats_json(struct stats *s)
 		json_object_set_new(obj, d->name, hist_json(h));
 	}
 
+	if (list_length(&s->pools) > 0) {
+		json_t *json_pools = json_array();
+
+		for (size_t i = 0; i < list_length(&s->pools); i++) {
+			struct pool *p = (struct pool *) list_at(&s->pools, i);
+			struct queue_occupancy o;
+
+			pool_occupancy(p, &o);
+
+			json_array_append_new(json_pools, stats_occupancy_json(&o));
+		}
+
+		json_object_set_new(obj, "pools", json_pools);
+	}
+
+	if (list_length(&s->queues) > 0) {
+		json_t *json_queues = json_array();
+
+		for (size_t i = 0; i < list_length(&s->queues); i++) {
+			struct queue *q = (struct queue *) list_at(&s->queues, i);
+			struct queue_occupancy o;
+
+			queue_occupancy(q, &o);
+
+			json_array_append_new(json_queues, stats_occupancy_json(&o));
+		}
+
+		json_object_set_new(obj, "queues", json_queues);
+	}
+
+	if (list_length(&s->overruns) > 0)
+		json_object_set_new(obj, "overrun", json_integer(stats_overruns(s)));
+
 	return obj;
 }
 
+json_t * stats_occupancy_json(struct queue_occupancy *o)
+{
+	return json_pack("{ s: I, s: I, s: I, s: I }",
+		"capacity",	(json_int_t) o->capacity,
+		"fill",		(json_int_t) o->fill,
+		"highwater",	(json_int_t) o->highwater,
+		"failures",	(json_int_t) o->failures
+	);
+}
+
+void stats_add_pool(struct stats *s, struct pool *p)
+{
+	list_push(&s->pools, p);
+}
+
+void stats_add_queue(struct stats *s, struct queue *q)
+{
+	list_push(&s->queues, q);
+}
+
+void stats_add_overruns(struct stats *s, atomic_size_t *cnt)
+{
+	list_push(&s->overruns, cnt);
+}
+
+size_t stats_overruns(struct stats *s)
+{
+	size_t total = 0;
+
+	for (size_t i = 0; i < list_length(&s->overruns); i++)
+		total += atomic_load((atomic_size_t *) list_at(&s->overruns, i));
+
+	return total;
+}
+
+void stats_remove(struct stats *s, void *ptr)
+{
+	list_remove(&s->pools, ptr);
+	list_remove(&s->queues, ptr);
+	list_remove(&s->overruns, ptr);
+}
+
 json_t * stats_json_periodic(struct stats *s, struct node *n)
 {
-	return json_pack("{ s: s, s: i, s: i, s: f, s: f, s: i, s: i }",
+	return json_pack("{ s: s, s: i, s: i, s: f, s: f, s: i, s: i, s: i }",
 		"node", node_name(n),
 		"received", hist_total(&s->histograms[STATS_OWD]),
 		"sent", hist_total(&s->histograms[STATS_TIME]),
 		"owd", hist_last(&s->histograms[STATS_OWD]),
 		"rate", 1.0 / hist_last(&s->histograms[STATS_GAP_SAMPLE]),
 		"dropped", hist_total(&s->histograms[STATS_REORDERED]),
-		"skipped", hist_total(&s->histograms[STATS_SKIPPED])
+		"skipped", hist_total(&s->histograms[STATS_SKIPPED]),
+		"overrun", (int) stats_overruns(s)
 	);
 }
 
@@ -62,7 +62,10 @@ int super_node_init(struct super_node *sn)
 	sn->affinity = 0;
 	sn->priority = 0;
 	sn->stats = 0;
+	sn->workers = 0;
 	sn->hugepages = DEFAULT_NR_HUGEPAGES;
+	sn->arena = 0;
+	sn->hugepage_size = HUGEPAGESIZE;
 
 	sn->name = alloc(128); /** @todo missing free */
 	gethostname(sn->name, 128);
@@ -173,6 +176,7 @@ int super_node_parse_json(struct super_node *sn, json_t *cfg)
 {
 	int ret;
 	const char *name = NULL;
+	const char *hugepage_size = NULL;
 
 	assert(sn->state != STATE_STARTED);
 	assert(sn->state != STATE_DESTROYED);
@@ -185,15 +189,18 @@ int super_node_parse_json(struct super_node *sn, json_t *cfg)
 
 	json_error_t err;
 
-	ret = json_unpack_ex(cfg, &err, 0, "{ s?: o, s?: o, s?: o, s?: o, s?: o, s?: i, s?: i, s?: i, s?: F, s?: s }",
+	ret = json_unpack_ex(cfg, &err, 0, "{ s?: o, s?: o, s?: o, s?: o, s?: o, s?: i, s?: b, s?: s, s?: i, s?: i, s?: i, s?: F, s?: s }",
 		"http", &json_web,
 		"logging", &json_logging,
 		"plugins", &json_plugins,
 		"nodes", &json_nodes,
 		"paths", &json_paths,
 		"hugepages", &sn->hugepages,
+		"arena", &sn->arena,
+		"hugepage_size", &hugepage_size,
 		"affinity", &sn->affinity,
 		"priority", &sn->priority,
+		"workers", &sn->workers,
 		"stats", &sn->stats,
 		"name", &name
 	);
@@ -203,6 +210,15 @@ int super_node_parse_json(struct super_node *sn, json_t *cfg)
 	if (name)
 		strncpy(sn->name, name, 128);
 
+	if (hugepage_size) {
+		if      (!strcmp(hugepage_size, "2M"))
+			sn->hugepage_size = HUGEPAGESIZE;
+		else if (!strcmp(hugepage_size, "1G"))
+			sn->hugepage_size = HUGEPAGESIZE_1G;
+		else
+			error("Invalid hugepage size '%s'. Supported sizes are '2M' and '1G'", hugepage_size);
+	}
+
 #ifdef WITH_WEB
 	if (json_web)
 		web_parse(&sn->web, json_web);
@@ -334,6 +350,33 @@ int super_node_check(struct super_node *sn)
 	return 0;
 }
 
+/** Sum up the hugepage memory which is required by all nodes and paths which will be started. */
+static size_t super_node_footprint(struct super_node *sn)
+{
+	size_t len = 0;
+
+	for (size_t i = 0; i < list_length(&sn->nodes); i++) {
+		struct node *n = (struct node *) list_at(&sn->nodes, i);
+
+		if (list_count(&sn->paths, (cmp_cb_t) path_uses_node, n) > 0)
+			len += node_footprint(n);
+	}
+
+	for (size_t i = 0; i < list_length(&sn->paths); i++) {
+		struct path *p = (struct path *) list_at(&sn->paths, i);
+
+		if (p->enabled) {
+			size_t plen = path_footprint(p);
+
+			debug(LOG_MEM | 5, "Path %s requires %zu bytes of hugepage memory", path_name(p), plen);
+
+			len += plen;
+		}
+	}
+
+	return len;
+}
+
 int super_node_start(struct super_node *sn)
 {
 	int ret;
@@ -341,6 +384,14 @@ int super_node_start(struct super_node *sn)
 	assert(sn->state == STATE_CHECKED);
 
 	memory_init(sn->hugepages);
+
+	if (sn->arena) {
+		size_t len = super_node_footprint(sn);
+
+		ret = memory_arena_init(len, sn->hugepage_size);
+		if (ret)
+			error("Failed to reserve %zu bytes of hugepage memory for the nodes and paths", len);
+	}
 	rt_init(sn->priority, sn->affinity);
 
 	log_start(&sn->log);
@@ -378,11 +429,25 @@ int super_node_start(struct super_node *sn)
 			warn("No path is using the node %s. Skipping...", node_name(n));
 	}
 
+	if (sn->workers > 0) {
+		ret = reactor_init(&sn->reactor, sn->workers, sn->affinity);
+		if (ret)
+			error("Failed to initialize reactor");
+
+		ret = reactor_start(&sn->reactor);
+		if (ret)
+			error("Failed to start reactor");
+	}
+
 	info("Starting paths");
 	for (size_t i = 0; i < list_length(&sn->paths); i++) { INDENT
 		struct path *p = (struct path *) list_at(&sn->paths, i);
 
 		if (p->enabled) { INDENT
+			/* Busy-polling paths and paths with their own scheduling settings keep their dedicated thread */
+			if (sn->workers > 0 && !p->polling && !p->affinity && !p->priority && p->deadline.runtime <= 0)
+				p->reactor = &sn->reactor;
+
 			ret = path_init2(p);
 			if (ret)
 				error("Failed to start path: %s", path_name(p));
@@ -404,6 +469,13 @@ int super_node_stop(struct super_node *sn)
 {
 	int ret;
 
+	/* Workers must not run any path while it is being stopped */
+	if (sn->workers > 0) {
+		ret = reactor_stop(&sn->reactor);
+		if (ret)
+			error("Failed to stop reactor");
+	}
+
 	info("Stopping paths");
 	for (size_t i = 0; i < list_length(&sn->paths); i++) { INDENT
 		struct path *p = (struct path *) list_at(&sn->paths, i);
@@ -454,6 +526,9 @@ int super_node_destroy(struct super_node *sn)
 	list_destroy(&sn->paths,   (dtor_cb_t) path_destroy, true);
 	list_destroy(&sn->nodes,   (dtor_cb_t) node_destroy, true);
 
+	if (sn->workers > 0 && sn->reactor.state != STATE_DESTROYED)
+		reactor_destroy(&sn->reactor);
+
 #ifdef WITH_WEB
 	web_destroy(&sn->web);
 #endif /* WITH_WEB */
@@ -461,6 +536,9 @@ int super_node_destroy(struct super_node *sn)
 	api_destroy(&sn->api);
 #endif /* WITH_API */
 
+	/* All pools and queues have been released */
+	memory_arena_destroy();
+
 	json_decref(sn->cfg);
 	log_destroy(&sn->log);
 
@@ -0,0 +1,129 @@
+/** Thin wrapper around liburing for asynchronous node I/O.
+ *
+ * @author Steffen Vogel <stvogel@eonerc.rwth-aachen.de>
+ * @copyright 2017, Institute for Automation of Complex Power Systems, EONERC
+ * @license GNU General Public License (version 3)
+ *
+ * VILLASnode
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *********************************************************************************/
+
+#include <errno.h>
+
+#include "utils.h"
+#include "uring.h"
+
+int uring_init(struct uring *u, unsigned depth)
+{
+	int ret;
+
+	assert(u->state == STATE_DESTROYED);
+
+	ret = io_uring_queue_init(depth, &u->ring, 0);
+	if (ret < 0) {
+		errno = -ret;
+		return -1;
+	}
+
+	u->inflight = 0;
+	u->state = STATE_INITIALIZED;
+
+	return 0;
+}
+
+int uring_destroy(struct uring *u)
+{
+	int ret;
+
+	if (u->state == STATE_DESTROYED)
+		return 0;
+
+	ret = uring_wait(u);
+
+	io_uring_queue_exit(&u->ring);
+
+	u->state = STATE_DESTROYED;
+
+	return ret;
+}
+
+struct io_uring_sqe * uring_get_sqe(struct uring *u)
+{
+	struct io_uring_sqe *sqe;
+
+	sqe = io_uring_get_sqe(&u->ring);
+	if (!sqe) {
+		if (uring_submit(u) < 0)
+			return NULL;
+
+		sqe = io_uring_get_sqe(&u->ring);
+		if (!sqe)
+			return NULL;
+	}
+
+	u->inflight++;
+
+	return sqe;
+}
+
+int uring_submit(struct uring *u)
+{
+	int ret;
+
+	ret = io_uring_submit(&u->ring);
+	if (ret < 0) {
+		errno = -ret;
+		return -1;
+	}
+
+	return ret;
+}
+
+int uring_wait(struct uring *u)
+{
+	int ret, res = 0;
+	unsigned n;
+
+	struct io_uring_cqe *cqes[URING_MAX_BATCH];
+
+	while (u->inflight > 0) {
+		ret = io_uring_wait_cqe_nr(&u->ring, &cqes[0], MIN(u->inflight, URING_MAX_BATCH));
+		if (ret < 0) {
+			if (ret == -EINTR)
+				continue;
+
+			errno = -ret;
+			return -1;
+		}
+
+		n = io_uring_peek_batch_cqe(&u->ring, cqes, MIN(u->inflight, URING_MAX_BATCH));
+
+		for (int i = 0; i < n; i++) {
+			if (cqes[i]->res < 0 && !res)
+				res = cqes[i]->res;
+		}
+
+		io_uring_cq_advance(&u->ring, n);
+
+		u->inflight -= n;
+	}
+
+	if (res < 0) {
+		errno = -res;
+		return -1;
+	}
+
+	return 0;
+}
@@ -144,12 +144,19 @@ check:		if (optarg == endptr)
 }
 
 void test_rtt() {
+	int ret;
 	struct hist hist;
+	struct pool pool = { .state = STATE_DESTROYED };
 
 	struct timespec send, recv;
 
-	struct sample *smp_send = (struct sample *) alloc(SAMPLE_LEN(2));
-	struct sample *smp_recv = (struct sample *) alloc(SAMPLE_LEN(2));
+	/* Samples must be allocated from a pool: they are cache line aligned */
+	ret = pool_init(&pool, 2, SAMPLE_LEN(2), &memtype_heap);
+	if (ret)
+		error("Failed to allocate samples");
+
+	struct sample *smp_send = sample_alloc(&pool);
+	struct sample *smp_recv = sample_alloc(&pool);
 
 	hist_init(&hist, 20, 100);
 
@@ -190,4 +197,9 @@ void test_rtt() {
 	hist_print(&hist, 1);
 
 	hist_destroy(&hist);
+
+	sample_put(smp_send);
+	sample_put(smp_recv);
+
+	pool_destroy(&pool);
 }
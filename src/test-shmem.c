@@ -57,6 +57,7 @@ int main(int argc, char* argv[])
 		.queuelen = DEFAULT_SHMEM_QUEUELEN,
 		.samplelen = DEFAULT_SHMEM_SAMPLELEN,
 		.polling = 0,
+		.spin = 0,
 	};
 
 	log_init(&log, V, LOG_ALL);
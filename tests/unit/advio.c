@@ -28,6 +28,8 @@
 #include <villas/utils.h>
 #include <villas/advio.h>
 #include <villas/sample.h>
+#include <villas/pool.h>
+#include <villas/memory.h>
 #include <villas/io/villas_human.h>
 
 /** This URI points to a Sciebo share which contains some test files.
@@ -89,8 +91,14 @@ Test(advio, download_large)
 	AFILE *af;
 	int ret, len = 16;
 
-	struct sample *smp = (struct sample *) alloc(SAMPLE_LEN(len));
-	smp->capacity = len;
+	/* Samples must be allocated from a pool: they are cache line aligned */
+	struct pool p = { .state = STATE_DESTROYED };
+
+	ret = pool_init(&p, 1, SAMPLE_LEN(len), &memtype_heap);
+	cr_assert_eq(ret, 0);
+
+	struct sample *smp = sample_alloc(&p);
+	cr_assert_not_null(smp);
 
 	af = afopen(BASE_URI "/download-large" , "r");
 	cr_assert(af, "Failed to download file");
@@ -110,6 +118,11 @@ Test(advio, download_large)
 
 	ret = afclose(af);
 	cr_assert_eq(ret, 0, "Failed to close file");
+
+	sample_put(smp);
+
+	ret = pool_destroy(&p);
+	cr_assert_eq(ret, 0);
 }
 
 Test(advio, resume)
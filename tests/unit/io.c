@@ -71,8 +71,6 @@ void generate_samples(struct pool *p, struct sample *smps[], struct sample *smpt
 	cr_assert_eq(ret, cnt);
 
 	for (int i = 0; i < cnt; i++) {
-		smpt[i]->capacity = values;
-
 		smps[i]->length = values;
 		smps[i]->sequence = 235 + i;
 		smps[i]->format = 0; /* all float */
@@ -94,7 +92,7 @@ void cr_assert_eq_samples(struct io_format *f, struct sample *smps[], struct sam
 	 */
 	if (f->sscan == raw_sscan) {
 		cr_assert_eq(cnt, 1);
-		cr_assert_eq(smpt[0]->length, smpt[0]->capacity, "Expected values: %d, Received values: %d", smpt[0]->capacity, smpt[0]->length);
+		cr_assert_eq(smpt[0]->length, smps[0]->length, "Expected values: %d, Received values: %d", smps[0]->length, smpt[0]->length);
 
 		if (f->flags & RAW_FAKE) {
 
@@ -25,6 +25,9 @@
 #include "mapping.h"
 #include "node.h"
 #include "list.h"
+#include "pool.h"
+#include "sample.h"
+#include "utils.h"
 
 Test(mapping, parse_nodes)
 {
@@ -149,3 +152,82 @@ Test(mapping, parse)
 	ret = mapping_parse_str(&m, "data[5-3]", NULL);
 	cr_assert_eq(ret, -1);
 }
+
+Test(mapping, plan)
+{
+	int ret;
+	struct list l = { .state = STATE_DESTROYED };
+	struct mapping_plan p = { .state = STATE_DESTROYED };
+	struct pool pool = { .state = STATE_DESTROYED };
+	struct sample *smps[3];
+
+	const char *strs[] = { "data[0-1]", "data[2-3]", "hdr.sequence", "data[8-9]", "ts.origin" };
+	int offset = 0;
+
+	list_init(&l);
+
+	for (int i = 0; i < ARRAY_LEN(strs); i++) {
+		struct mapping_entry *me = alloc(sizeof(struct mapping_entry));
+
+		ret = mapping_parse_str(me, strs[i], NULL);
+		cr_assert_eq(ret, 0);
+
+		me->offset = offset;
+		offset += me->length;
+
+		list_push(&l, me);
+	}
+
+	ret = mapping_plan_init(&p, &l, NULL);
+	cr_assert_eq(ret, 0);
+
+	/* The first two data ranges are merged */
+	cr_assert_eq(p.nsteps, ARRAY_LEN(strs) - 1);
+	cr_assert_eq(p.length, offset);
+
+	ret = pool_init(&pool, 3, SAMPLE_LEN(16), &memtype_heap);
+	cr_assert_eq(ret, 0);
+
+	ret = sample_alloc_many(&pool, smps, 3);
+	cr_assert_eq(ret, 3);
+
+	smps[0]->sequence = 1234;
+	smps[0]->length = 9;
+	smps[0]->ts.origin.tv_sec = 5;
+	smps[0]->ts.origin.tv_nsec = 6;
+
+	for (int i = 0; i < smps[0]->length; i++)
+		smps[0]->data[i].f = i;
+
+	sample_set_data_format(smps[0], 1, SAMPLE_DATA_FORMAT_INT);
+
+	ret = mapping_remap(&l, smps[1], smps[0], NULL);
+	cr_assert_eq(ret, 0);
+
+	ret = mapping_plan_remap(&p, smps[2], smps[0]);
+	cr_assert_eq(ret, 0);
+
+	/* data[9] does not exist in the original sample */
+	cr_assert_eq(smps[2]->length, offset);
+	cr_assert_eq(smps[2]->data[4].i, 1234);
+	cr_assert_eq(smps[2]->data[5].f, 8);
+	cr_assert_eq(smps[2]->data[6].f, 0);
+	cr_assert_eq(smps[2]->data[7].i, 5);
+	cr_assert_eq(sample_get_data_format(smps[2], 1), SAMPLE_DATA_FORMAT_INT);
+
+	smps[1]->flags = smps[2]->flags = SAMPLE_HAS_SEQUENCE | SAMPLE_HAS_VALUES;
+
+	ret = sample_cmp(smps[1], smps[2], 0, SAMPLE_HAS_SEQUENCE | SAMPLE_HAS_VALUES);
+	cr_assert_eq(ret, 0);
+
+	sample_free_many(smps, 3);
+
+	ret = pool_destroy(&pool);
+	cr_assert_eq(ret, 0);
+
+	ret = mapping_plan_destroy(&p);
+	cr_assert_eq(ret, 0);
+
+	ret = list_destroy(&l, NULL, true);
+	cr_assert_eq(ret, 0);
+}
@@ -59,8 +59,8 @@ Test(memory, manager) {
 	void *p, *p1, *p2, *p3;
 	struct memtype *m;
 
-	total_size = 1 << 10;
-	max_block = total_size - sizeof(struct memtype) - sizeof(struct memblock);
+	total_size = 1 << 12;
+	max_block = total_size - sizeof(struct memtype) - sizeof(struct memmanager) - sizeof(struct memblock);
 
 	p = memory_alloc(&memtype_heap, total_size);
 	cr_assert_not_null(p);
@@ -103,3 +103,46 @@ Test(memory, manager) {
 	ret = memory_free(&memtype_heap, p, total_size);
 	cr_assert(ret == 0);
 }
+
+Test(memory, manager_coalesce) {
+	int ret;
+	size_t total_size, max_block;
+	void *p, *q, *ptrs[64];
+	struct memtype *m;
+
+	total_size = 1 << 16;
+	max_block = total_size - sizeof(struct memtype) - sizeof(struct memmanager) - sizeof(struct memblock);
+
+	p = memory_alloc(&memtype_heap, total_size);
+	cr_assert_not_null(p);
+
+	m = memtype_managed_init(p, total_size);
+	cr_assert_not_null(m);
+
+	for (int i = 0; i < ARRAY_LEN(ptrs); i++) {
+		ptrs[i] = memory_alloc_aligned(m, 24 + i * 8, 64);
+		cr_assert_not_null(ptrs[i]);
+		cr_assert(IS_ALIGNED(ptrs[i], 64));
+	}
+
+	/* Release every other block first, so that both neighbours have to be merged later */
+	for (int i = 0; i < ARRAY_LEN(ptrs); i += 2) {
+		ret = memory_free(m, ptrs[i], 24 + i * 8);
+		cr_assert_eq(ret, 0);
+	}
+
+	for (int i = 1; i < ARRAY_LEN(ptrs); i += 2) {
+		ret = memory_free(m, ptrs[i], 24 + i * 8);
+		cr_assert_eq(ret, 0);
+	}
+
+	/* All blocks have been merged into a single one again */
+	q = memory_alloc(m, max_block);
+	cr_assert_not_null(q);
+
+	ret = memory_free(m, q, max_block);
+	cr_assert_eq(ret, 0);
+
+	ret = memory_free(&memtype_heap, p, total_size);
+	cr_assert_eq(ret, 0);
+}
@@ -80,3 +80,102 @@ ParameterizedTest(struct param *p, pool, basic)
 	cr_assert_eq(ret, 0, "Failed to destroy pool");
 
 }
+
+Test(pool, cache)
+{
+	int ret;
+	ssize_t cnt;
+	uint64_t hits, misses;
+	struct pool pool = { .state = STATE_DESTROYED };
+
+	void *ptr, *ptrs[64];
+
+	ret = pool_init(&pool, 64, 8, &memtype_heap);
+	cr_assert_eq(ret, 0, "Failed to create pool");
+
+	ret = pool_cache_init(&pool, 8);
+	cr_assert_eq(ret, 0, "Failed to enable pool cache");
+
+	/* Blocks in the magazine of this thread are still available to it */
+	for (int i = 0; i < 64; i++) {
+		ptrs[i] = pool_get(&pool);
+		cr_assert_neq(ptrs[i], NULL);
+
+		for (int j = 0; j < i; j++)
+			cr_assert_neq(ptrs[i], ptrs[j], "Block %d has been handed out twice", i);
+	}
+
+	ptr = pool_get(&pool);
+	cr_assert_eq(ptr, NULL);
+
+	cnt = pool_put_many(&pool, ptrs, 64);
+	cr_assert_eq(cnt, 64);
+
+	/* Recently returned blocks are served from the magazine */
+	for (int i = 0; i < 4; i++) {
+		ptr = pool_get(&pool);
+		cr_assert_neq(ptr, NULL);
+
+		pool_put(&pool, ptr);
+	}
+
+	pool_cache_stats(&pool, &hits, &misses);
+	cr_assert_geq(hits, 8);
+	cr_assert_gt(misses, 0);
+
+	cnt = pool_get_many(&pool, ptrs, 64);
+	cr_assert_eq(cnt, 64);
+
+	ret = pool_destroy(&pool);
+	cr_assert_eq(ret, 0, "Failed to destroy pool");
+}
+
+Test(pool, occupancy)
+{
+	int ret;
+	ssize_t cnt;
+	struct pool pool = { .state = STATE_DESTROYED };
+	struct queue_occupancy o;
+
+	void *ptrs[16];
+
+	ret = pool_init(&pool, 16, 8, &memtype_heap);
+	cr_assert_eq(ret, 0, "Failed to create pool");
+
+	pool_occupancy_enable(&pool);
+
+	cnt = pool_get_many(&pool, ptrs, 12);
+	cr_assert_eq(cnt, 12);
+
+	cnt = pool_put_many(&pool, ptrs, 8);
+	cr_assert_eq(cnt, 8);
+
+	pool_occupancy(&pool, &o);
+	cr_assert_eq(o.capacity, 16);
+	cr_assert_eq(o.fill, 4);
+	cr_assert_eq(o.highwater, 12);
+	cr_assert_eq(o.failures, 0);
+
+	/* Only 12 blocks are left */
+	cnt = pool_get_many(&pool, ptrs, 16);
+	cr_assert_eq(cnt, 12);
+
+	pool_occupancy(&pool, &o);
+	cr_assert_eq(o.fill, 16);
+	cr_assert_eq(o.highwater, 16);
+	cr_assert_eq(o.failures, 4);
+
+	/* A failed pull must not be accounted as returned blocks */
+	ret = queue_close(&pool.queue);
+	cr_assert_eq(ret, 0);
+
+	cnt = pool_get_many(&pool, ptrs, 4);
+	cr_assert_eq(cnt, -1);
+
+	pool_occupancy(&pool, &o);
+	cr_assert_eq(o.fill, 16);
+	cr_assert_eq(o.failures, 8);
+
+	ret = pool_destroy(&pool);
+	cr_assert_eq(ret, 0, "Failed to destroy pool");
+}
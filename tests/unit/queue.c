@@ -236,7 +236,7 @@ Test(queue, single_threaded)
 		.start = 1 /* we start immeadiatly */
 	};
 
-	ret = queue_init(&p.queue, p.queue_size, &memtype_heap);
+	ret = queue_init(&p.queue, p.queue_size, &memtype_heap, QUEUE_MPMC);
 	cr_assert_eq(ret, 0, "Failed to create queue");
 
 	producer(&p);
@@ -248,6 +248,88 @@ Test(queue, single_threaded)
 	cr_assert_eq(ret, 0, "Failed to create queue");
 }
 
+Test(queue, many)
+{
+	int ret;
+	struct queue q = { .state = STATE_DESTROYED };
+
+	uintptr_t in[3 * SIZE / 2], out[3 * SIZE / 2];
+
+	for (int i = 0; i < ARRAY_LEN(in); i++)
+		in[i] = i + 1;
+
+	ret = queue_init(&q, SIZE, &memtype_heap, QUEUE_MPMC);
+	cr_assert_eq(ret, 0, "Failed to create queue");
+
+	/* Only as many elements as there are free cells are reserved */
+	ret = queue_push_many(&q, (void **) in, ARRAY_LEN(in));
+	cr_assert_eq(ret, SIZE);
+
+	ret = queue_pull_many(&q, (void **) out, SIZE / 2);
+	cr_assert_eq(ret, SIZE / 2);
+
+	/* The second batch wraps around the end of the buffer */
+	ret = queue_push_many(&q, (void **) &in[SIZE], ARRAY_LEN(in) - SIZE);
+	cr_assert_eq(ret, SIZE / 2);
+
+	ret = queue_pull_many(&q, (void **) &out[SIZE / 2], ARRAY_LEN(out) - SIZE / 2);
+	cr_assert_eq(ret, SIZE);
+
+	for (int i = 0; i < ARRAY_LEN(out); i++)
+		cr_assert_eq(out[i], in[i], "Elements are out of order: out[%d] = %lu", i, out[i]);
+
+	ret = queue_pull_many(&q, (void **) out, ARRAY_LEN(out));
+	cr_assert_eq(ret, 0);
+
+	ret = queue_destroy(&q);
+	cr_assert_eq(ret, 0, "Failed to destroy queue");
+}
+
+Test(queue, occupancy)
+{
+	int ret;
+	struct queue q = { .state = STATE_DESTROYED };
+	struct queue_occupancy o;
+
+	uintptr_t in[SIZE + 4], out[SIZE];
+
+	for (int i = 0; i < ARRAY_LEN(in); i++)
+		in[i] = i + 1;
+
+	ret = queue_init(&q, SIZE, &memtype_heap, QUEUE_MPMC | QUEUE_OCCUPANCY);
+	cr_assert_eq(ret, 0, "Failed to create queue");
+
+	ret = queue_push_many(&q, (void **) in, SIZE / 2);
+	cr_assert_eq(ret, SIZE / 2);
+
+	ret = queue_pull_many(&q, (void **) out, SIZE / 4);
+	cr_assert_eq(ret, SIZE / 4);
+
+	queue_occupancy(&q, &o);
+	cr_assert_eq(o.capacity, SIZE);
+	cr_assert_eq(o.fill, SIZE / 4);
+	cr_assert_eq(o.highwater, SIZE / 2);
+	cr_assert_eq(o.failures, 0);
+
+	/* Pointers which do not fit anymore are counted as failures */
+	ret = queue_push_many(&q, (void **) in, ARRAY_LEN(in));
+	cr_assert_eq(ret, SIZE - SIZE / 4);
+
+	ret = queue_push(&q, (void *) in[0]);
+	cr_assert_eq(ret, 0);
+
+	ret = queue_pull_many(&q, (void **) out, SIZE);
+	cr_assert_eq(ret, SIZE);
+
+	queue_occupancy(&q, &o);
+	cr_assert_eq(o.fill, 0);
+	cr_assert_eq(o.highwater, SIZE);
+	cr_assert_eq(o.failures, ARRAY_LEN(in) - (SIZE - SIZE / 4) + 1);
+
+	ret = queue_destroy(&q);
+	cr_assert_eq(ret, 0, "Failed to destroy queue");
+}
+
 ParameterizedTestParameters(queue, multi_threaded)
 {
 	static struct param params[] = {
@@ -300,7 +382,7 @@ ParameterizedTest(struct param *p, queue, multi_threaded, .timeout = 20)
 
 	p->start = 0;
 
-	ret = queue_init(&p->queue, p->queue_size, &memtype_heap);
+	ret = queue_init(&p->queue, p->queue_size, &memtype_heap, QUEUE_MPMC);
 	cr_assert_eq(ret, 0, "Failed to create queue");
 
 	uint64_t start_tsc_time, end_tsc_time;
@@ -341,7 +423,7 @@ Test(queue, init_destroy)
 	int ret;
 	struct queue q = { .state = STATE_DESTROYED };
 
-	ret = queue_init(&q, 1024, &memtype_heap);
+	ret = queue_init(&q, 1024, &memtype_heap, QUEUE_MPMC);
 	cr_assert_eq(ret, 0); /* Should succeed */
 
 	ret = queue_destroy(&q);
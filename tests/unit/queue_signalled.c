@@ -115,9 +115,14 @@ ParameterizedTestParameters(queue_signalled, simple)
 		{ QUEUE_SIGNALLED_PTHREAD, consumer },
 		{ QUEUE_SIGNALLED_PTHREAD | QUEUE_SIGNALLED_PROCESS_SHARED, consumer },
 		{ QUEUE_SIGNALLED_POLLING, consumer },
+		{ QUEUE_SIGNALLED_POLLING | QUEUE_SIGNALLED_SPSC, consumer },
 #ifdef __linux__
 		{ QUEUE_SIGNALLED_EVENTFD, consumer },
-		{ QUEUE_SIGNALLED_EVENTFD, polled_consumer }
+		{ QUEUE_SIGNALLED_EVENTFD, polled_consumer },
+		{ QUEUE_SIGNALLED_EVENTFD | QUEUE_SIGNALLED_SPSC, polled_consumer },
+		{ QUEUE_SIGNALLED_ADAPTIVE, consumer },
+		{ QUEUE_SIGNALLED_ADAPTIVE | QUEUE_SIGNALLED_SPSC, consumer },
+		{ QUEUE_SIGNALLED_ADAPTIVE | QUEUE_SIGNALLED_PROCESS_SHARED, consumer }
 #endif
 	};
 	
@@ -0,0 +1,85 @@
+/** Unit tests for samples
+ *
+ * @author Steffen Vogel <stvogel@eonerc.rwth-aachen.de>
+ * @copyright 2017, Institute for Automation of Complex Power Systems, EONERC
+ * @license GNU General Public License (version 3)
+ *
+ * VILLASnode
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *********************************************************************************/
+
+#include <criterion/criterion.h>
+
+#include <stddef.h>
+
+#include "pool.h"
+#include "sample.h"
+#include "utils.h"
+
+#define NUM_VALUES	200
+
+Test(sample, layout)
+{
+	/* All fields which are used during processing share the first cache line */
+	cr_assert_leq(offsetof(struct sample, ts.received) + sizeof(struct timespec), 64);
+	cr_assert_eq(offsetof(struct sample, data) % 64, 0);
+}
+
+Test(sample, data_format)
+{
+	int ret;
+	struct pool pool = { .state = STATE_DESTROYED };
+	struct sample *smps[2];
+
+	ret = pool_init(&pool, 2, SAMPLE_LEN(NUM_VALUES), &memtype_heap);
+	cr_assert_eq(ret, 0, "Failed to create pool");
+
+	ret = sample_alloc_many(&pool, smps, 2);
+	cr_assert_eq(ret, 2);
+
+	cr_assert_geq(smps[0]->capacity, NUM_VALUES);
+	cr_assert_eq((uintptr_t) smps[0]->data % 64, 0);
+
+	smps[0]->length = NUM_VALUES;
+	smps[0]->flags = SAMPLE_HAS_VALUES;
+
+	/* Every third value is an integer, also beyond SAMPLE_FORMAT_INLINE */
+	for (int i = 0; i < NUM_VALUES; i++) {
+		if (i % 3 == 0) {
+			sample_set_data_format(smps[0], i, SAMPLE_DATA_FORMAT_INT);
+			smps[0]->data[i].i = i;
+		}
+		else
+			smps[0]->data[i].f = i;
+	}
+
+	for (int i = 0; i < NUM_VALUES; i++)
+		cr_assert_eq(sample_get_data_format(smps[0], i), i % 3 == 0 ? SAMPLE_DATA_FORMAT_INT : SAMPLE_DATA_FORMAT_FLOAT);
+
+	sample_copy(smps[1], smps[0]);
+
+	ret = sample_cmp(smps[0], smps[1], 0, SAMPLE_HAS_VALUES);
+	cr_assert_eq(ret, 0);
+
+	sample_set_data_format(smps[1], NUM_VALUES - 1, SAMPLE_DATA_FORMAT_INT);
+
+	ret = sample_cmp(smps[0], smps[1], 0, SAMPLE_HAS_VALUES);
+	cr_assert_neq(ret, 0);
+
+	sample_free_many(smps, 2);
+
+	ret = pool_destroy(&pool);
+	cr_assert_eq(ret, 0, "Failed to destroy pool");
+}
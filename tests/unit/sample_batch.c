@@ -0,0 +1,160 @@
+/** Unit tests for structure-of-arrays sample batches
+ *
+ * @author Steffen Vogel <stvogel@eonerc.rwth-aachen.de>
+ * @copyright 2017, Institute for Automation of Complex Power Systems, EONERC
+ * @license GNU General Public License (version 3)
+ *
+ * VILLASnode
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *********************************************************************************/
+
+#include <criterion/criterion.h>
+
+#include "pool.h"
+#include "sample.h"
+#include "sample_batch.h"
+#include "utils.h"
+
+#define NUM_SAMPLES	10
+#define NUM_VALUES	5
+
+Test(sample_batch, roundtrip)
+{
+	int ret;
+	struct pool pool = { .state = STATE_DESTROYED };
+	struct sample_batch batch = { .state = STATE_DESTROYED };
+	struct sample *smps[NUM_SAMPLES], *copies[NUM_SAMPLES];
+
+	ret = pool_init(&pool, 2 * NUM_SAMPLES, SAMPLE_LEN(NUM_VALUES), &memtype_heap);
+	cr_assert_eq(ret, 0, "Failed to create pool");
+
+	ret = sample_alloc_many(&pool, smps, NUM_SAMPLES);
+	cr_assert_eq(ret, NUM_SAMPLES);
+
+	ret = sample_alloc_many(&pool, copies, NUM_SAMPLES);
+	cr_assert_eq(ret, NUM_SAMPLES);
+
+	for (int j = 0; j < NUM_SAMPLES; j++) {
+		smps[j]->sequence = j;
+		smps[j]->length = j == 3 ? 2 : NUM_VALUES;
+		smps[j]->flags = SAMPLE_HAS_SEQUENCE | SAMPLE_HAS_ORIGIN | SAMPLE_HAS_RECEIVED | SAMPLE_HAS_VALUES;
+		smps[j]->ts.origin = (struct timespec) { .tv_sec = j, .tv_nsec = 100 };
+		smps[j]->ts.received = (struct timespec) { .tv_sec = j, .tv_nsec = 200 };
+
+		for (int i = 0; i < smps[j]->length; i++)
+			smps[j]->data[i].f = j * 10 + i;
+	}
+
+	/* The batch holds less rows than samples */
+	ret = sample_batch_init(&batch, NUM_SAMPLES - 2, NUM_VALUES, &memtype_heap);
+	cr_assert_eq(ret, 0, "Failed to create sample batch");
+
+	ret = sample_batch_from_samples(&batch, smps, NUM_SAMPLES);
+	cr_assert_eq(ret, NUM_SAMPLES - 2);
+	cr_assert_eq(batch.length, NUM_SAMPLES - 2);
+
+	for (int i = 0; i < NUM_VALUES; i++) {
+		union sample_batch_value *col = sample_batch_column(&batch, i);
+
+		cr_assert_eq((uintptr_t) col % SAMPLE_BATCH_ALIGN, 0, "Column %d is not aligned", i);
+
+		for (int j = 0; j < batch.length; j++) {
+			if (j == 3 && i >= 2)
+				cr_assert_eq(col[j].f, 0);
+			else
+				cr_assert_eq(col[j].f, j * 10 + i);
+		}
+	}
+
+	ret = sample_batch_to_samples(&batch, copies, NUM_SAMPLES);
+	cr_assert_eq(ret, NUM_SAMPLES - 2);
+
+	for (int j = 0; j < NUM_SAMPLES - 2; j++) {
+		ret = sample_cmp(smps[j], copies[j], 0, SAMPLE_HAS_SEQUENCE | SAMPLE_HAS_ORIGIN | SAMPLE_HAS_VALUES);
+		cr_assert_eq(ret, 0, "Sample %d differs after conversion", j);
+
+		cr_assert_eq(copies[j]->ts.received.tv_nsec, 200);
+	}
+
+	ret = sample_batch_destroy(&batch);
+	cr_assert_eq(ret, 0, "Failed to destroy sample batch");
+
+	sample_free_many(smps, NUM_SAMPLES);
+	sample_free_many(copies, NUM_SAMPLES);
+
+	ret = pool_destroy(&pool);
+	cr_assert_eq(ret, 0, "Failed to destroy pool");
+}
+
+Test(sample_batch, wide)
+{
+	int ret, values = SAMPLE_FORMAT_INLINE + 10;
+	struct pool pool = { .state = STATE_DESTROYED };
+	struct sample_batch batch = { .state = STATE_DESTROYED };
+	struct sample *smps[2], *copies[2];
+
+	ret = pool_init(&pool, 4, SAMPLE_LEN(values), &memtype_heap);
+	cr_assert_eq(ret, 0, "Failed to create pool");
+
+	ret = sample_alloc_many(&pool, smps, 2);
+	cr_assert_eq(ret, 2);
+
+	ret = sample_alloc_many(&pool, copies, 2);
+	cr_assert_eq(ret, 2);
+
+	/* Integer columns on both sides of SAMPLE_FORMAT_INLINE */
+	for (int j = 0; j < 2; j++) {
+		smps[j]->length = values;
+		smps[j]->flags = SAMPLE_HAS_VALUES;
+
+		for (int i = 0; i < values; i++) {
+			if (i == 3 || i == SAMPLE_FORMAT_INLINE + 5) {
+				sample_set_data_format(smps[j], i, SAMPLE_DATA_FORMAT_INT);
+				smps[j]->data[i].i = j * 1000 + i;
+			}
+			else
+				smps[j]->data[i].f = j * 1000 + i;
+		}
+
+		/* Stale bits which must be overwritten */
+		sample_set_data_format(copies[j], SAMPLE_FORMAT_INLINE + 6, SAMPLE_DATA_FORMAT_INT);
+	}
+
+	ret = sample_batch_init(&batch, 2, values, &memtype_heap);
+	cr_assert_eq(ret, 0, "Failed to create sample batch");
+
+	ret = sample_batch_from_samples(&batch, smps, 2);
+	cr_assert_eq(ret, 2);
+
+	ret = sample_batch_to_samples(&batch, copies, 2);
+	cr_assert_eq(ret, 2);
+
+	for (int j = 0; j < 2; j++) {
+		ret = sample_cmp(smps[j], copies[j], 0, SAMPLE_HAS_VALUES);
+		cr_assert_eq(ret, 0, "Sample %d differs after conversion", j);
+
+		cr_assert_eq(sample_get_data_format(copies[j], SAMPLE_FORMAT_INLINE + 5), SAMPLE_DATA_FORMAT_INT);
+		cr_assert_eq(sample_get_data_format(copies[j], SAMPLE_FORMAT_INLINE + 6), SAMPLE_DATA_FORMAT_FLOAT);
+	}
+
+	ret = sample_batch_destroy(&batch);
+	cr_assert_eq(ret, 0, "Failed to destroy sample batch");
+
+	sample_free_many(smps, 2);
+	sample_free_many(copies, 2);
+
+	ret = pool_destroy(&pool);
+	cr_assert_eq(ret, 0, "Failed to destroy pool");
+}